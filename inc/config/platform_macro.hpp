@@ -2,4 +2,6 @@
 
 #ifdef _WIN32
 #define CW_CONFIG_USE_PLATFORM_WINDOWS
+#elif defined(__linux__)
+#define CW_CONFIG_USE_PLATFORM_XCB
 #endif
\ No newline at end of file
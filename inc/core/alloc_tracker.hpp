@@ -0,0 +1,215 @@
+#pragma once
+
+#include "./integer.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+
+/*
+	heap allocations counted per subsystem tag, fed by replacements of the global operator new / delete :
+		CW_ALLOC_TAG(e_render);	// allocations of the enclosing scope on this thread are counted as render
+	the tag guards are only compiled in when CW_CONFIG_ENABLE_ALLOC_TRACKING is defined, the replacements moreover only in the
+	translation unit that defines CW_ALLOC_TRACKER_IMPLEMENTATION before including this header, as stb does
+	a freed block is given back to the tag it was allocated with, threads outside of any guard count as e_untagged
+	memory_t's heap_allocator_t always goes through operator new, direct malloc calls (stb_image, drivers) aren't counted
+	the macro has to be the same for every translation unit, cmake sets it with -DCW_ENABLE_ALLOC_TRACKING=ON
+*/
+
+namespace cw {
+	namespace core {
+		enum class alloc_tag_e : std::uint8_t {
+			e_untagged, e_logic, e_render, e_window, e_core, e_count
+		};
+		inline const char* to_string(alloc_tag_e tag) {
+			switch (tag) {
+			case alloc_tag_e::e_untagged: return "untagged";
+			case alloc_tag_e::e_logic: return "logic";
+			case alloc_tag_e::e_render: return "render";
+			case alloc_tag_e::e_window: return "window";
+			case alloc_tag_e::e_core: return "core";
+			default: return "null";
+			}
+		}
+		struct alloc_stats_t {
+			std::uint64_t alloc_count = 0;
+			std::uint64_t free_count = 0;
+			std::uint64_t alloc_byte = 0; // allocated in total
+			std::uint64_t live_byte = 0;
+			std::uint64_t peak_byte = 0; // high-water mark of live_byte
+		};
+		// what one frame allocated, peak_byte is the high-water mark within the frame
+		struct alloc_report_t {
+			std::uint64_t frame = 0;
+			std::array<alloc_stats_t, static_cast<std::size_t>(alloc_tag_e::e_count)> tags;
+			decltype(auto) alloc_count() const { std::uint64_t result = 0; for (const auto& iter : tags) result += iter.alloc_count; return result; }
+			decltype(auto) alloc_byte() const { std::uint64_t result = 0; for (const auto& iter : tags) result += iter.alloc_byte; return result; }
+			void log(std::ostream& os) const {
+				os << "frame " << frame << " : " << alloc_count() << " allocations, " << alloc_byte() << " bytes";
+				for (std::size_t i = 0; i < tags.size(); ++i) {
+					if (tags[i].alloc_count == 0 && tags[i].free_count == 0) continue;
+					os << ", " << to_string(static_cast<alloc_tag_e>(i)) << " " << tags[i].alloc_count << " / " << tags[i].free_count << " freed (" << tags[i].alloc_byte << " bytes, peak " << tags[i].peak_byte << ")";
+				}
+				os << std::endl;
+			}
+		};
+		// lock free counters, its own bookkeeping never allocates so operator new can call it
+		class alloc_tracker_t {
+		public:
+			static decltype(auto) instance() { static alloc_tracker_t tracker; return (tracker); }
+			// tag of the allocations of the calling thread
+			static decltype(auto) tag() { thread_local alloc_tag_e tag = alloc_tag_e::e_untagged; return (tag); }
+
+			void on_alloc(alloc_tag_e tag, std::size_t byte) noexcept {
+				auto& counter = m_counters[static_cast<std::size_t>(tag)];
+				counter.alloc_count.fetch_add(1, std::memory_order_relaxed);
+				counter.alloc_byte.fetch_add(byte, std::memory_order_relaxed);
+				auto live = counter.live_byte.fetch_add(byte, std::memory_order_relaxed) + byte;
+				raise(counter.peak_byte, live);
+				raise(counter.frame_peak_byte, live);
+			}
+			void on_free(alloc_tag_e tag, std::size_t byte) noexcept {
+				auto& counter = m_counters[static_cast<std::size_t>(tag)];
+				counter.free_count.fetch_add(1, std::memory_order_relaxed);
+				counter.live_byte.fetch_sub(byte, std::memory_order_relaxed);
+			}
+			// since the start of the process
+			decltype(auto) stats(alloc_tag_e tag) const {
+				auto& counter = m_counters[static_cast<std::size_t>(tag)];
+				alloc_stats_t result;
+				result.alloc_count = counter.alloc_count.load(std::memory_order_relaxed);
+				result.free_count = counter.free_count.load(std::memory_order_relaxed);
+				result.alloc_byte = counter.alloc_byte.load(std::memory_order_relaxed);
+				result.live_byte = counter.live_byte.load(std::memory_order_relaxed);
+				result.peak_byte = counter.peak_byte.load(std::memory_order_relaxed);
+				return result;
+			}
+			// closes the frame, its report covers everything since the previous call, the first call only starts counting
+			decltype(auto) end_frame() {
+				m_report.frame = m_frame++;
+				for (std::size_t i = 0; i < m_counters.size(); ++i) {
+					auto current = stats(static_cast<alloc_tag_e>(i));
+					auto& last = m_frame_start[i];
+					auto& report = m_report.tags[i];
+					report.alloc_count = current.alloc_count - last.alloc_count;
+					report.free_count = current.free_count - last.free_count;
+					report.alloc_byte = current.alloc_byte - last.alloc_byte;
+					report.live_byte = current.live_byte;
+					report.peak_byte = m_counters[i].frame_peak_byte.exchange(current.live_byte, std::memory_order_relaxed);
+					last = current;
+				}
+				return (m_report);
+			}
+			decltype(auto) last_frame() const { return (m_report); }
+			void log(std::ostream& os) const {
+				for (std::size_t i = 0; i < m_counters.size(); ++i) {
+					auto stats = this->stats(static_cast<alloc_tag_e>(i));
+					os << to_string(static_cast<alloc_tag_e>(i)) << " : " << stats.alloc_count << " allocations, " << stats.free_count << " frees, "
+						<< stats.alloc_byte << " bytes, " << stats.live_byte << " live, peak " << stats.peak_byte << std::endl;
+				}
+			}
+		private:
+			struct counter_t {
+				std::atomic<std::uint64_t> alloc_count{ 0 };
+				std::atomic<std::uint64_t> free_count{ 0 };
+				std::atomic<std::uint64_t> alloc_byte{ 0 };
+				std::atomic<std::uint64_t> live_byte{ 0 };
+				std::atomic<std::uint64_t> peak_byte{ 0 };
+				std::atomic<std::uint64_t> frame_peak_byte{ 0 };
+			};
+			static void raise(std::atomic<std::uint64_t>& peak, std::uint64_t value) noexcept {
+				auto current = peak.load(std::memory_order_relaxed);
+				while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+			}
+		private:
+			std::array<counter_t, static_cast<std::size_t>(alloc_tag_e::e_count)> m_counters;
+			std::array<alloc_stats_t, static_cast<std::size_t>(alloc_tag_e::e_count)> m_frame_start;
+			alloc_report_t m_report;
+			std::uint64_t m_frame = 0;
+		};
+		class alloc_scope_t {
+		public:
+			alloc_scope_t(alloc_tag_e tag) : m_previous(std::exchange(alloc_tracker_t::tag(), tag)) {}
+			alloc_scope_t(alloc_scope_t const&) = delete;
+			alloc_scope_t& operator=(alloc_scope_t const&) = delete;
+			~alloc_scope_t() { alloc_tracker_t::tag() = m_previous; }
+		private:
+			alloc_tag_e m_previous;
+		};
+	}
+}
+
+#define CW_ALLOC_CONCAT_PRIV(a, b) a##b
+#define CW_ALLOC_CONCAT(a, b) CW_ALLOC_CONCAT_PRIV(a, b)
+#ifdef CW_CONFIG_ENABLE_ALLOC_TRACKING
+#define CW_ALLOC_TAG(tag) ::cw::core::alloc_scope_t CW_ALLOC_CONCAT(cw_alloc_tag_, __COUNTER__)(::cw::core::alloc_tag_e::tag)
+#else
+#define CW_ALLOC_TAG(tag) ((void)0)
+#endif
+
+#if defined(CW_CONFIG_ENABLE_ALLOC_TRACKING) && defined(CW_ALLOC_TRACKER_IMPLEMENTATION)
+namespace cw {
+	namespace core {
+		namespace priv {
+			// right in front of every tracked block
+			struct alloc_header_t {
+				void* block; // from malloc
+				std::size_t byte;
+				alloc_tag_e tag;
+			};
+			inline void* tracked_allocate(std::size_t byte, std::size_t alignment) noexcept {
+				if (alignment < __STDCPP_DEFAULT_NEW_ALIGNMENT__) alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+				auto block = std::malloc(byte + sizeof(alloc_header_t) + alignment);
+				if (block == nullptr) return nullptr;
+				auto data = (reinterpret_cast<std::uintptr_t>(block) + sizeof(alloc_header_t) + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+				auto tag = alloc_tracker_t::tag();
+				*(reinterpret_cast<alloc_header_t*>(data) - 1) = { block, byte, tag };
+				alloc_tracker_t::instance().on_alloc(tag, byte);
+				return reinterpret_cast<void*>(data);
+			}
+			inline void tracked_free(void* data) noexcept {
+				if (data == nullptr) return;
+				auto header = static_cast<alloc_header_t*>(data) - 1;
+				alloc_tracker_t::instance().on_free(header->tag, header->byte);
+				std::free(header->block);
+			}
+			inline void* tracked_new(std::size_t byte, std::size_t alignment) {
+				if (byte == 0) byte = 1;
+				while (true) {
+					if (auto result = tracked_allocate(byte, alignment)) return result;
+					auto handler = std::get_new_handler();
+					if (handler == nullptr) throw std::bad_alloc();
+					handler();
+				}
+			}
+			inline void* tracked_new(std::size_t byte, std::size_t alignment, std::nothrow_t const&) noexcept {
+				try { return tracked_new(byte, alignment); }
+				catch (...) { return nullptr; }
+			}
+		}
+	}
+}
+void* operator new(std::size_t byte) { return cw::core::priv::tracked_new(byte, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t byte) { return cw::core::priv::tracked_new(byte, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t byte, std::align_val_t alignment) { return cw::core::priv::tracked_new(byte, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t byte, std::align_val_t alignment) { return cw::core::priv::tracked_new(byte, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t byte, std::nothrow_t const& tag) noexcept { return cw::core::priv::tracked_new(byte, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag); }
+void* operator new[](std::size_t byte, std::nothrow_t const& tag) noexcept { return cw::core::priv::tracked_new(byte, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag); }
+void* operator new(std::size_t byte, std::align_val_t alignment, std::nothrow_t const& tag) noexcept { return cw::core::priv::tracked_new(byte, static_cast<std::size_t>(alignment), tag); }
+void* operator new[](std::size_t byte, std::align_val_t alignment, std::nothrow_t const& tag) noexcept { return cw::core::priv::tracked_new(byte, static_cast<std::size_t>(alignment), tag); }
+void operator delete(void* data) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete[](void* data) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete(void* data, std::size_t) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete[](void* data, std::size_t) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete(void* data, std::align_val_t) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete[](void* data, std::align_val_t) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete(void* data, std::size_t, std::align_val_t) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete[](void* data, std::size_t, std::align_val_t) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete(void* data, std::nothrow_t const&) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete[](void* data, std::nothrow_t const&) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete(void* data, std::align_val_t, std::nothrow_t const&) noexcept { cw::core::priv::tracked_free(data); }
+void operator delete[](void* data, std::align_val_t, std::nothrow_t const&) noexcept { cw::core::priv::tracked_free(data); }
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "./memory.hpp"
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace cw {
+	namespace core {
+		/*
+			transient allocations of the frames in flight, not thread safe :
+				begin_frame() resets the arena of the oldest frame and bumps from it until the next call,
+				so with the default frame_count the data of the previous frame stays valid through the current one
+			a full arena falls back to the heap until its next reset and warns once, overflow_byte() tells by how much
+		*/
+		class frame_arena_t {
+		public:
+			frame_arena_t(ull_t capacity, ull_t frame_count = 2) {
+				assert(frame_count > 0);
+				for (ull_t i = 0; i < frame_count; ++i) m_frames.push_back(std::make_unique<frame_t>(capacity));
+			}
+			frame_arena_t(frame_arena_t const&) = delete;
+			frame_arena_t& operator=(frame_arena_t const&) = delete;
+			~frame_arena_t() { for (auto& iter : m_frames) reset(*iter); }
+
+			void begin_frame() {
+				m_current = (m_current + 1) % m_frames.size();
+				reset(*m_frames[m_current]);
+			}
+			void* allocate(ull_t byte, ull_t alignment) {
+				auto& frame = *m_frames[m_current];
+				if (auto result = frame.arena.allocate(byte, alignment)) return result;
+				auto result = ::operator new(byte, std::align_val_t(alignment));
+				frame.overflow.push_back({ result, alignment });
+				frame.overflow_byte += byte;
+				return result;
+			}
+			// only the latest allocation of the current frame is given back, the rest waits for the reset
+			void deallocate(void* data, ull_t byte) { m_frames[m_current]->arena.deallocate(data, byte); }
+			decltype(auto) used() const { return m_frames[m_current]->arena.used(); }
+			decltype(auto) capacity() const { return m_frames[m_current]->arena.capacity(); }
+			decltype(auto) overflow_byte() const { return m_frames[m_current]->overflow_byte; }
+			decltype(auto) frame_count() const { return static_cast<ull_t>(m_frames.size()); }
+		private:
+			struct frame_t {
+				frame_t(ull_t capacity) : arena(capacity) {}
+				arena_t arena;
+				std::vector<std::pair<void*, ull_t>> overflow; // heap blocks and their alignment
+				ull_t overflow_byte = 0;
+			};
+			void reset(frame_t& frame) {
+				if (frame.overflow_byte != 0 && !m_warned) {
+					std::cerr << "frame arena overflowed by " << frame.overflow_byte << " bytes, raise its capacity of " << frame.arena.capacity() << " bytes" << std::endl;
+					m_warned = true;
+				}
+				for (const auto& iter : frame.overflow) ::operator delete(iter.first, std::align_val_t(iter.second));
+				frame.overflow.clear();
+				frame.overflow_byte = 0;
+				frame.arena.reset();
+			}
+		private:
+			std::vector<std::unique_ptr<frame_t>> m_frames;
+			ull_t m_current = 0;
+			bool m_warned = false;
+		};
+		// stl allocator over a frame_arena_t, containers using it must not outlive the frame after the one they were filled in
+		template<typename _type>
+		class frame_allocator_t {
+		public:
+			using value_type = _type;
+			frame_allocator_t(frame_arena_t* arena) noexcept : m_arena(arena) { assert(m_arena); }
+			template<typename _other_type> frame_allocator_t(frame_allocator_t<_other_type> const& other) noexcept : m_arena(other.arena()) {}
+			_type* allocate(std::size_t size) { return static_cast<_type*>(m_arena->allocate(sizeof(_type) * size, alignof(_type))); }
+			void deallocate(_type* data, std::size_t size) noexcept { m_arena->deallocate(data, sizeof(_type) * size); }
+			decltype(auto) arena() const noexcept { return m_arena; }
+			template<typename _other_type> bool operator==(frame_allocator_t<_other_type> const& other) const noexcept { return m_arena == other.arena(); }
+			template<typename _other_type> bool operator!=(frame_allocator_t<_other_type> const& other) const noexcept { return m_arena != other.arena(); }
+		private:
+			frame_arena_t* m_arena;
+		};
+		template<typename _type> using frame_vector_t = std::vector<_type, frame_allocator_t<_type>>;
+	}
+}
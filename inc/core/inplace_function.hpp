@@ -0,0 +1,77 @@
+#pragma once
+
+#include "./integer.hpp"
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cw {
+	namespace core {
+		template<typename _signature, ull_t _capacity = 64, ull_t _alignment = alignof(std::max_align_t)>
+		class inplace_function_t;
+		/*
+			std::function without the heap : the callable is stored in _capacity bytes inside the object, a bigger one doesn't compile
+			copies and moves copy or move the callable, calling an empty one asserts
+		*/
+		template<typename _result, typename... _args, ull_t _capacity, ull_t _alignment>
+		class inplace_function_t<_result(_args...), _capacity, _alignment> {
+		public:
+			inplace_function_t() noexcept = default;
+			inplace_function_t(std::nullptr_t) noexcept {}
+			template<typename _callable, typename = std::enable_if_t<!std::is_same_v<std::decay_t<_callable>, inplace_function_t>>>
+			inplace_function_t(_callable&& callable) {
+				using type = std::decay_t<_callable>;
+				static_assert(sizeof(type) <= _capacity, "the callable doesn't fit in the inplace function, capture less or raise the capacity");
+				static_assert(alignof(type) <= _alignment, "the callable is aligned stricter than the inplace function");
+				static_assert(std::is_invocable_r_v<_result, type&, _args...>, "the callable doesn't match the signature");
+				::new (static_cast<void*>(&m_storage)) type(std::forward<_callable>(callable));
+				m_ops = &ops_of<type>;
+			}
+			inplace_function_t(inplace_function_t const& other) : m_ops(other.m_ops) { if (m_ops) m_ops->copy(&m_storage, &other.m_storage); }
+			inplace_function_t(inplace_function_t&& other) noexcept : m_ops(other.m_ops) { if (m_ops) m_ops->move(&m_storage, &other.m_storage); }
+			~inplace_function_t() { reset(); }
+			inplace_function_t& operator=(inplace_function_t const& other) {
+				if (this == &other) return *this;
+				reset();
+				if (other.m_ops) other.m_ops->copy(&m_storage, &other.m_storage);
+				m_ops = other.m_ops;
+				return *this;
+			}
+			inplace_function_t& operator=(inplace_function_t&& other) noexcept {
+				if (this == &other) return *this;
+				reset();
+				if (other.m_ops) other.m_ops->move(&m_storage, &other.m_storage);
+				m_ops = other.m_ops;
+				return *this;
+			}
+			inplace_function_t& operator=(std::nullptr_t) noexcept { reset(); return *this; }
+
+			_result operator()(_args... args) const { assert(m_ops); return m_ops->invoke(&m_storage, std::forward<_args>(args)...); }
+			explicit operator bool() const noexcept { return m_ops != nullptr; }
+			void reset() noexcept {
+				if (m_ops) m_ops->destroy(&m_storage);
+				m_ops = nullptr;
+			}
+		private:
+			struct ops_t {
+				_result(*invoke)(void* data, _args&&... args);
+				void(*copy)(void* data, const void* other);
+				void(*move)(void* data, void* other) noexcept;
+				void(*destroy)(void* data) noexcept;
+			};
+			template<typename _type> static constexpr ops_t ops_of = {
+				[](void* data, _args&&... args) -> _result { return std::invoke(*static_cast<_type*>(data), std::forward<_args>(args)...); },
+				[](void* data, const void* other) { ::new (data) _type(*static_cast<const _type*>(other)); },
+				[](void* data, void* other) noexcept { ::new (data) _type(std::move(*static_cast<_type*>(other))); },
+				[](void* data) noexcept { static_cast<_type*>(data)->~_type(); }
+			};
+		private:
+			// called through const like std::function, the callable itself may be mutable
+			mutable std::aligned_storage_t<_capacity, _alignment> m_storage;
+			const ops_t* m_ops = nullptr;
+		};
+	}
+}
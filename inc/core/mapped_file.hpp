@@ -0,0 +1,82 @@
+#pragma once
+
+#include "./../config/platform_macro.hpp"
+#include "./memory.hpp"
+#include <string>
+
+#ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cw {
+	namespace core {
+		// read-only view of a whole file mapped into the address space
+		class mapped_file_t {
+		public:
+			mapped_file_t(std::string const& path) : m_byte(0), m_data(nullptr) {
+#ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
+				m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+				if (m_file == INVALID_HANDLE_VALUE) { m_file = nullptr; return; }
+				LARGE_INTEGER size{};
+				if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) { clean(); return; }
+				m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (!m_mapping) { clean(); return; }
+				m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+				if (!m_data) { clean(); return; }
+				m_byte = static_cast<ull_t>(size.QuadPart);
+#else
+				m_file = open(path.c_str(), O_RDONLY);
+				if (m_file < 0) return;
+				struct stat status {};
+				if (fstat(m_file, &status) != 0 || status.st_size == 0) { clean(); return; }
+				auto data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+				if (data == MAP_FAILED) { clean(); return; }
+				m_data = data;
+				m_byte = static_cast<ull_t>(status.st_size);
+#endif
+			}
+			mapped_file_t(mapped_file_t const&) = delete;
+			mapped_file_t& operator=(mapped_file_t const&) = delete;
+			~mapped_file_t() { clean(); }
+
+			decltype(auto) is_open() const { return m_data != nullptr; }
+			decltype(auto) byte() const { return m_byte; }
+			decltype(auto) data() const { return (const void*)m_data; }
+			decltype(auto) view(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) const {
+				ull_t byte_size = byte.has_value() ? byte.value() : m_byte - offset;
+				assert(offset + byte_size <= m_byte);
+				return memory_view_t(byte_size, static_cast<void*>(static_cast<byte_t*>(m_data) + offset));
+			}
+		private:
+			void clean() {
+#ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
+				if (m_data) UnmapViewOfFile(m_data);
+				if (m_mapping) CloseHandle(m_mapping);
+				if (m_file) CloseHandle(m_file);
+				m_mapping = nullptr;
+				m_file = nullptr;
+#else
+				if (m_data) munmap(m_data, static_cast<size_t>(m_byte));
+				if (m_file >= 0) close(m_file);
+				m_file = -1;
+#endif
+				m_data = nullptr;
+				m_byte = 0;
+			}
+		private:
+			ull_t m_byte;
+			void* m_data;
+#ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
+			HANDLE m_file = nullptr;
+			HANDLE m_mapping = nullptr;
+#else
+			int m_file = -1;
+#endif
+		};
+	}
+}
@@ -4,7 +4,13 @@
 #include <optional>
 #include <vector>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <iostream>
+#include <new>
+#include <utility>
 
 namespace cw {
 	namespace core {
@@ -34,7 +40,7 @@ namespace cw {
 			template<typename _type> decltype(auto) ref(ull_t index = 0) { return *at<_type>(index); }
 			template<typename _type> decltype(auto) ref(ull_t index = 0) const { return *at<_type>(index); }
 			decltype(auto) sub_view(ull_t offset, ull_t byte) { assert(offset + byte <= m_byte); return memory_view_t(byte, at(offset)); }
-			decltype(auto) sub_view(ull_t offset, ull_t byte) const { assert(offset + byte <= m_byte); return (const memory_view_t(byte, const_cast<void*>(at(offset)))); }
+			decltype(auto) sub_view(ull_t offset, ull_t byte) const { assert(offset + byte <= m_byte); return memory_view_t(byte, const_cast<void*>(at(offset))); }
 			decltype(auto) copy_from(ull_t byte, void* data, ull_t offset = 0) { assert(is_byte(offset + byte, false)); memcpy(static_cast<void*>(static_cast<byte_t*>(m_data) + offset), data, byte); return *this; }
 			decltype(auto) copy_from(memory_view_t const& view, ull_t offset = 0) { assert(is_byte(offset + view.m_byte, false)); memcpy(static_cast<void*>(static_cast<byte_t*>(m_data) + offset), view.m_data, view.m_byte); return *this; }
 			//decltype(auto) at_byte(ull_t byte) { assert(is_byte(byte)); return static_cast<void*>(static_cast<byte_t*>(m_data) + byte); }
@@ -47,55 +53,204 @@ namespace cw {
 			ull_t m_byte;
 			void* m_data;
 		};
-		class memory_t {
+		namespace func {
+			inline decltype(auto) align_up(ull_t value, ull_t alignment) { assert(alignment != 0 && (alignment & (alignment - 1)) == 0); return (value + alignment - 1) & ~(alignment - 1); }
+		}
+		// bump allocation in one block, memory comes back by reset() or by freeing the latest allocation
+		class arena_t {
 		public:
-			memory_t(ull_t byte = 0, void* data = nullptr) : m_byte(byte), m_data(byte != 0 ? (data ? memcpy(new byte_t[byte], data, byte) : memset(new byte_t[byte], 0, byte)) : nullptr) {}
-			memory_t(memory_view_t& view) : memory_t(view.byte(), view.data()) {}
-			template<typename _type> memory_t(std::vector<_type>& vector) : memory_t(sizeof(_type)* vector.size(), static_cast<void*>(vector.data())) {}
-			~memory_t() { clean(); }
-			decltype(auto) reset(ull_t byte = 0, void* data = nullptr) { clean(); m_byte = byte; m_data = (byte != 0 ? (data ? memcpy(new byte_t[byte], data, byte) : memset(new byte_t[byte], 0, byte)) : nullptr); return *this; }
+			arena_t(ull_t capacity, ull_t alignment = 64) : m_capacity(capacity), m_alignment(alignment), m_data(static_cast<byte_t*>(::operator new(capacity, std::align_val_t(alignment)))) {}
+			arena_t(arena_t const&) = delete;
+			arena_t& operator=(arena_t const&) = delete;
+			~arena_t() { ::operator delete(m_data, std::align_val_t(m_alignment)); }
+			// nullptr when the arena is full
+			void* allocate(ull_t byte, ull_t alignment) {
+				auto address = reinterpret_cast<std::uintptr_t>(m_data);
+				auto offset = func::align_up(address + m_offset, alignment) - address;
+				if (offset + byte > m_capacity) return nullptr;
+				m_last = offset;
+				m_offset = offset + byte;
+				return m_data + offset;
+			}
+			void deallocate(void* data, ull_t byte) { if (is_last(data, byte)) m_offset = m_last; }
+			// only the latest allocation grows or shrinks
+			bool resize(void* data, ull_t byte, ull_t new_byte) {
+				if (!is_last(data, byte) || m_last + new_byte > m_capacity) return false;
+				m_offset = m_last + new_byte;
+				return true;
+			}
+			void reset() { m_offset = m_last = 0; }
+			decltype(auto) used() const { return m_offset; }
+			decltype(auto) capacity() const { return m_capacity; }
+		private:
+			bool is_last(void* data, ull_t byte) const { return data == m_data + m_last && m_last + byte == m_offset; }
+		private:
+			ull_t m_capacity;
+			ull_t m_alignment;
+			byte_t* m_data;
+			ull_t m_offset = 0;
+			ull_t m_last = 0;
+		};
+		// fixed size blocks carved from chunks of block_count blocks, freed blocks are handed out first
+		class pool_t {
+		public:
+			pool_t(ull_t block_byte, ull_t alignment = 64, ull_t block_count = 64) :
+				m_block_byte(func::align_up(block_byte > sizeof(void*) ? block_byte : sizeof(void*), alignment)), m_alignment(alignment), m_block_count(block_count) {}
+			pool_t(pool_t const&) = delete;
+			pool_t& operator=(pool_t const&) = delete;
+			~pool_t() { for (auto iter : m_chunks) ::operator delete(iter, std::align_val_t(m_alignment)); }
+			void* allocate(ull_t byte, ull_t alignment) {
+				assert(byte <= m_block_byte && alignment <= m_alignment);
+				if (m_free == nullptr) grow();
+				auto result = m_free;
+				m_free = *static_cast<void**>(m_free);
+				return result;
+			}
+			void deallocate(void* data) {
+				*static_cast<void**>(data) = m_free;
+				m_free = data;
+			}
+			bool resize(void*, ull_t, ull_t new_byte) const { return new_byte <= m_block_byte; }
+			decltype(auto) block_byte() const { return m_block_byte; }
+		private:
+			void grow() {
+				auto chunk = static_cast<byte_t*>(::operator new(m_block_byte * m_block_count, std::align_val_t(m_alignment)));
+				m_chunks.push_back(chunk);
+				for (ull_t i = m_block_count; i-- > 0;) deallocate(chunk + i * m_block_byte);
+			}
+		private:
+			ull_t m_block_byte;
+			ull_t m_alignment;
+			ull_t m_block_count;
+			void* m_free = nullptr;
+			std::vector<void*> m_chunks;
+		};
+		/*
+			allocator policies of basic_memory_t :
+				void* allocate(ull_t byte, ull_t alignment)								nullptr on failure
+				void deallocate(void* data, ull_t byte, ull_t alignment)
+				void* reallocate(void* data, ull_t byte, ull_t new_byte, ull_t alignment)	keeps min(byte, new_byte) bytes, nullptr when the caller has to allocate and copy
+		*/
+		// operator new / delete, up to alignof(std::max_align_t), growing allocates and copies
+		// the same definition in every translation unit whatever the configuration, alloc_tracker.hpp counts it when its replacements are built in
+		struct heap_allocator_t {
+			void* allocate(ull_t byte, ull_t alignment) { assert(alignment <= alignof(std::max_align_t)); return ::operator new(byte, std::nothrow); }
+			void deallocate(void* data, ull_t, ull_t) { ::operator delete(data); }
+			void* reallocate(void*, ull_t, ull_t, ull_t) { return nullptr; }
+		};
+		// any power of two, for simd data and mapped gpu copies
+		struct aligned_allocator_t {
+			void* allocate(ull_t byte, ull_t alignment) { return ::operator new(byte, std::align_val_t(alignment), std::nothrow); }
+			void deallocate(void* data, ull_t, ull_t alignment) { ::operator delete(data, std::align_val_t(alignment)); }
+			void* reallocate(void*, ull_t, ull_t, ull_t) { return nullptr; }
+		};
+		struct arena_allocator_t {
+			arena_t* arena = nullptr;
+			void* allocate(ull_t byte, ull_t alignment) { assert(arena); return arena->allocate(byte, alignment); }
+			void deallocate(void* data, ull_t byte, ull_t) { arena->deallocate(data, byte); }
+			void* reallocate(void* data, ull_t byte, ull_t new_byte, ull_t) { return arena->resize(data, byte, new_byte) ? data : nullptr; }
+		};
+		struct pool_allocator_t {
+			pool_t* pool = nullptr;
+			void* allocate(ull_t byte, ull_t alignment) { assert(pool); return byte <= pool->block_byte() ? pool->allocate(byte, alignment) : nullptr; }
+			void deallocate(void* data, ull_t, ull_t) { pool->deallocate(data); }
+			void* reallocate(void* data, ull_t byte, ull_t new_byte, ull_t) { return pool->resize(data, byte, new_byte) ? data : nullptr; }
+		};
+		/*
+			owned bytes with an explicit alignment, the capacity is kept when shrinking so growing back doesn't allocate
+			rebyte() / resize() zero the new bytes like before, the _uninitialized versions leave them as they are
+		*/
+		template<typename _allocator_type = heap_allocator_t>
+		class basic_memory_t {
+		public:
+			using allocator_type = _allocator_type;
+			static constexpr ull_t default_alignment = alignof(std::max_align_t);
+
+			basic_memory_t(ull_t byte = 0, void* data = nullptr, ull_t alignment = default_alignment, allocator_type const& allocator = allocator_type()) : m_alignment(alignment), m_allocator(allocator) {
+				reset(byte, data);
+			}
+			basic_memory_t(memory_view_t& view) : basic_memory_t(view.byte(), view.data()) {}
+			template<typename _type> basic_memory_t(std::vector<_type>& vector) : basic_memory_t(sizeof(_type)* vector.size(), static_cast<void*>(vector.data())) {}
+			basic_memory_t(basic_memory_t const& other) : basic_memory_t(other.m_byte, other.m_data, other.m_alignment, other.m_allocator) {}
+			basic_memory_t(basic_memory_t&& other) noexcept :
+				m_byte(std::exchange(other.m_byte, 0)), m_capacity(std::exchange(other.m_capacity, 0)), m_alignment(other.m_alignment), m_data(std::exchange(other.m_data, nullptr)), m_allocator(other.m_allocator) {}
+			basic_memory_t& operator=(basic_memory_t other) noexcept {
+				std::swap(m_byte, other.m_byte);
+				std::swap(m_capacity, other.m_capacity);
+				std::swap(m_alignment, other.m_alignment);
+				std::swap(m_data, other.m_data);
+				std::swap(m_allocator, other.m_allocator);
+				return *this;
+			}
+			~basic_memory_t() { clean(); }
+			decltype(auto) reset(ull_t byte = 0, void* data = nullptr) {
+				rebyte_uninitialized(byte, false);
+				if (byte != 0) data ? memcpy(m_data, data, byte) : memset(m_data, 0, byte);
+				return *this;
+			}
 			decltype(auto) rebyte(ull_t byte, bool clean = true) {
-				auto old_byte = m_byte;
-				auto old_data = m_data;
-				m_byte = byte;
-				if (m_byte != 0) {
-					m_data = memset(new byte_t[m_byte], 0, m_byte);
-					if (!clean) memcpy(m_data, old_data, old_byte > m_byte ? m_byte : old_byte);
+				auto old_byte = clean ? 0 : (m_byte < byte ? m_byte : byte);
+				rebyte_uninitialized(byte, !clean);
+				if (byte > old_byte) memset(static_cast<byte_t*>(m_data) + old_byte, 0, byte - old_byte);
+				return *this;
+			}
+			// in place within the capacity, then through the allocator, a copy is the last resort
+			decltype(auto) rebyte_uninitialized(ull_t byte, bool keep = true) {
+				if (byte <= m_capacity) { m_byte = byte; return *this; }
+				if (keep && m_data) {
+					if (auto data = m_allocator.reallocate(m_data, m_capacity, byte, m_alignment)) {
+						m_data = data;
+						m_byte = m_capacity = byte;
+						return *this;
+					}
 				}
-				else m_data = nullptr;
-				delete old_data;
+				auto data = allocate(byte);
+				if (keep && m_byte != 0) memcpy(data, m_data, m_byte);
+				clean();
+				m_data = data;
+				m_byte = m_capacity = byte;
 				return *this;
 			}
+			decltype(auto) reserve(ull_t byte) { auto old_byte = m_byte; rebyte_uninitialized(byte > m_byte ? byte : m_byte); m_byte = old_byte; return *this; }
 			decltype(auto) resize(ull_t alignment, ull_t size, bool clean = true) { return rebyte(alignment * size, clean); }
 			template<typename _type> decltype(auto) resize(ull_t size, bool clean = true) { return rebyte(sizeof(_type) * size, clean); }
+			template<typename _type> decltype(auto) resize_uninitialized(ull_t size, bool keep = true) { return rebyte_uninitialized(sizeof(_type) * size, keep); }
 			decltype(auto) byte() const { return m_byte; }
+			decltype(auto) capacity() const { return m_capacity; }
+			decltype(auto) alignment() const { return m_alignment; }
+			decltype(auto) allocator() const { return m_allocator; }
 			decltype(auto) data() { return m_data; }
 			decltype(auto) data() const { return (const void*)m_data; }
 			decltype(auto) view(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) { return memory_view_t(valid(offset, byte), static_cast<void*>(static_cast<byte_t*>(m_data) + offset)); }
-			decltype(auto) view(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) const { return (const memory_view_t(valid(offset, byte), static_cast<void*>(static_cast<byte_t*>(m_data) + offset))); }
-			//decltype(auto) view(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) {
-			//	/*ull_t byte_size = byte.has_value() ? byte.value() : m_byte - offset;
-			//	assert(offset + byte_size <= m_byte);*/
-			//	return memory_view_t(valid(offset, byte), static_cast<void*>(static_cast<byte_t*>(m_data) + offset));
-			//}
-			//const auto view(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) const {
-			//	/*ull_t byte_size = byte.has_value() ? byte.value() : m_byte - offset;
-			//	assert(offset + byte_size <= m_byte);*/
-			//	return memory_view_t(valid(offset, byte), static_cast<void*>(static_cast<byte_t*>(m_data) + offset));
-			//}
-			//decltype(auto) set_byte(ull_t byte) { m_byte = byte; return *this; }
-			//decltype(auto) set_data(void* data) { m_data = data; return *this; }
+			decltype(auto) view(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) const { return memory_view_t(valid(offset, byte), static_cast<void*>(static_cast<byte_t*>(m_data) + offset)); }
 		private:
 			ull_t valid(ull_t offset = 0, std::optional<ull_t> byte = std::nullopt) const {
 				ull_t byte_size = byte.has_value() ? byte.value() : m_byte - offset;
 				assert(offset + byte_size <= m_byte);
 				return byte_size;
 			}
-			void clean() { m_byte = 0; if (m_data) { delete m_data; m_data = nullptr; } }
+			void* allocate(ull_t byte) {
+				auto result = m_allocator.allocate(byte, m_alignment);
+				if (result == nullptr) std::cerr << "can't allocate " << byte << " bytes aligned to " << m_alignment << std::endl;
+				assert(result);
+				return result;
+			}
+			void clean() {
+				if (m_data) m_allocator.deallocate(m_data, m_capacity, m_alignment);
+				m_data = nullptr;
+				m_byte = m_capacity = 0;
+			}
 		private:
-			ull_t m_byte;
-			void* m_data;
+			ull_t m_byte = 0;
+			ull_t m_capacity = 0;
+			ull_t m_alignment;
+			void* m_data = nullptr;
+			allocator_type m_allocator;
 		};
+		using memory_t = basic_memory_t<>;
+		using aligned_memory_t = basic_memory_t<aligned_allocator_t>;
+		using arena_memory_t = basic_memory_t<arena_allocator_t>;
+		using pool_memory_t = basic_memory_t<pool_allocator_t>;
 		//class memory_t {
 		//public:
 		//	memory_t() : m_alignment(0), m_size(0), m_data(nullptr) {}
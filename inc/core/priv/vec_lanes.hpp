@@ -0,0 +1,65 @@
+#pragma once
+
+#include "./inner_vec.hpp"
+#include "./../simd.hpp"
+#include <cstdint>
+
+namespace cw {
+	namespace core {
+		namespace priv {
+			/*
+				lane wise arithmetic and all-lanes comparisons of inner_vec_t<_type, _size>
+				scalar and constexpr in general, a vec4 of float or std::int32_t is one sse register and is 16 byte aligned for it
+			*/
+			template<typename _type, ull_t _size>
+			struct vec_lanes_t {
+				static constexpr ull_t alignment = alignof(_type);
+				static constexpr void add(_type* result, const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) result[i] = a[i] + b[i]; }
+				static constexpr void sub(_type* result, const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) result[i] = a[i] - b[i]; }
+				static constexpr void mul(_type* result, const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) result[i] = a[i] * b[i]; }
+				static constexpr void div(_type* result, const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) result[i] = a[i] / b[i]; }
+				static constexpr bool all_less(const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) if (!(a[i] < b[i])) return false; return true; }
+				static constexpr bool all_less_equal(const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) if (!(a[i] <= b[i])) return false; return true; }
+				static constexpr bool all_equal(const _type* a, const _type* b) noexcept { for (ull_t i = 0; i < _size; ++i) if (!(a[i] == b[i])) return false; return true; }
+			};
+#if defined(CW_SIMD_SSE2)
+			// _mm_mullo_epi32 is sse4.1, sse2 multiplies the even and the odd lanes apart
+			inline __m128i mullo_epi32(__m128i a, __m128i b) noexcept {
+#if defined(CW_SIMD_SSE41)
+				return _mm_mullo_epi32(a, b);
+#else
+				auto even = _mm_mul_epu32(a, b);
+				auto odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+				return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+			}
+			template<>
+			struct vec_lanes_t<float, 4> {
+				static constexpr ull_t alignment = 16;
+				static void add(float* result, const float* a, const float* b) noexcept { _mm_store_ps(result, _mm_add_ps(_mm_load_ps(a), _mm_load_ps(b))); }
+				static void sub(float* result, const float* a, const float* b) noexcept { _mm_store_ps(result, _mm_sub_ps(_mm_load_ps(a), _mm_load_ps(b))); }
+				static void mul(float* result, const float* a, const float* b) noexcept { _mm_store_ps(result, _mm_mul_ps(_mm_load_ps(a), _mm_load_ps(b))); }
+				static void div(float* result, const float* a, const float* b) noexcept { _mm_store_ps(result, _mm_div_ps(_mm_load_ps(a), _mm_load_ps(b))); }
+				static bool all_less(const float* a, const float* b) noexcept { return _mm_movemask_ps(_mm_cmplt_ps(_mm_load_ps(a), _mm_load_ps(b))) == 0xf; }
+				static bool all_less_equal(const float* a, const float* b) noexcept { return _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(a), _mm_load_ps(b))) == 0xf; }
+				static bool all_equal(const float* a, const float* b) noexcept { return _mm_movemask_ps(_mm_cmpeq_ps(_mm_load_ps(a), _mm_load_ps(b))) == 0xf; }
+			};
+			template<>
+			struct vec_lanes_t<std::int32_t, 4> {
+				static constexpr ull_t alignment = 16;
+				static __m128i load(const std::int32_t* data) noexcept { return _mm_load_si128(reinterpret_cast<const __m128i*>(data)); }
+				static void store(std::int32_t* data, __m128i value) noexcept { _mm_store_si128(reinterpret_cast<__m128i*>(data), value); }
+				static int mask(__m128i value) noexcept { return _mm_movemask_ps(_mm_castsi128_ps(value)); }
+				static void add(std::int32_t* result, const std::int32_t* a, const std::int32_t* b) noexcept { store(result, _mm_add_epi32(load(a), load(b))); }
+				static void sub(std::int32_t* result, const std::int32_t* a, const std::int32_t* b) noexcept { store(result, _mm_sub_epi32(load(a), load(b))); }
+				static void mul(std::int32_t* result, const std::int32_t* a, const std::int32_t* b) noexcept { store(result, mullo_epi32(load(a), load(b))); }
+				// no integer division in sse
+				static void div(std::int32_t* result, const std::int32_t* a, const std::int32_t* b) noexcept { for (ull_t i = 0; i < 4; ++i) result[i] = a[i] / b[i]; }
+				static bool all_less(const std::int32_t* a, const std::int32_t* b) noexcept { return mask(_mm_cmplt_epi32(load(a), load(b))) == 0xf; }
+				static bool all_less_equal(const std::int32_t* a, const std::int32_t* b) noexcept { return mask(_mm_cmpgt_epi32(load(a), load(b))) == 0; }
+				static bool all_equal(const std::int32_t* a, const std::int32_t* b) noexcept { return mask(_mm_cmpeq_epi32(load(a), load(b))) == 0xf; }
+			};
+#endif
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+	instruction sets the core kernels may use, taken from the compiler flags (msvc /arch:AVX2, gcc / clang -mavx2 ...)
+		CW_SIMD_SSE2	always on x64
+		CW_SIMD_SSE41	-msse4.1, or implied by /arch:AVX
+		CW_SIMD_AVX2	-mavx2, /arch:AVX2
+	defining CW_CONFIG_DISABLE_SIMD keeps every kernel on its scalar path
+*/
+
+#if !defined(CW_CONFIG_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CW_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define CW_SIMD_SSE41
+#include <smmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define CW_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#endif
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "./memory.hpp"
+#include "./simd.hpp"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+namespace cw {
+	namespace core {
+		/*
+			typed view on every stride bytes of a memory_view_t, starting offset bytes in :
+				strided_view_t<instance_t>(view)																the records of an aos buffer
+				strided_view_t<std::uint32_t>(view, sizeof(instance_t), offsetof(instance_t, texture_index))	one field of every record
+			a soa array is the contiguous case, stride == sizeof(_type)
+			elements keep the alignment of their type, as fields of a struct do
+		*/
+		template<typename _type>
+		class strided_view_t {
+			static_assert(std::is_trivially_copyable_v<_type>, "strided views copy their elements bytewise");
+			template<typename _other_type> friend class strided_view_t;
+		public:
+			using value_type = _type;
+			class iterator_t {
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = _type;
+				using difference_type = std::ptrdiff_t;
+				using pointer = _type*;
+				using reference = _type&;
+				iterator_t(byte_t* data = nullptr, ull_t stride = 0) : m_data(data), m_stride(stride) {}
+				_type& operator*() const { return *reinterpret_cast<_type*>(m_data); }
+				_type* operator->() const { return reinterpret_cast<_type*>(m_data); }
+				iterator_t& operator++() { m_data += m_stride; return *this; }
+				iterator_t operator++(int) { auto result = *this; m_data += m_stride; return result; }
+				bool operator==(iterator_t const& other) const { return m_data == other.m_data; }
+				bool operator!=(iterator_t const& other) const { return m_data != other.m_data; }
+			private:
+				byte_t* m_data;
+				ull_t m_stride;
+			};
+			strided_view_t() = default;
+			// by reference, a memory_view_t taken by value would be built from the view object itself by its catch-all constructor
+			strided_view_t(memory_view_t const& view, ull_t stride = sizeof(_type), ull_t offset = 0) :
+				m_data(static_cast<byte_t*>(const_cast<void*>(view.data()))), m_stride(stride),
+				m_size(view.byte() >= offset + sizeof(_type) ? (view.byte() - offset - sizeof(_type)) / stride + 1 : 0) {
+				assert(stride >= sizeof(_type));
+				if (m_data) m_data += offset;
+			}
+			decltype(auto) size() const { return m_size; }
+			decltype(auto) stride() const { return m_stride; }
+			decltype(auto) empty() const { return m_size == 0; }
+			decltype(auto) is_contiguous() const { return m_stride == sizeof(_type); }
+			decltype(auto) data() const { return static_cast<void*>(m_data); }
+			decltype(auto) address(ull_t index) const { assert(index < m_size); return static_cast<void*>(m_data + index * m_stride); }
+			_type& operator[](ull_t index) const { return *static_cast<_type*>(address(index)); }
+			decltype(auto) sub_view(ull_t first, ull_t count) const { assert(first + count <= m_size); return strided_view_t(m_data + first * m_stride, m_stride, count); }
+			// the member offset bytes into every element, e.g. field<std::uint32_t>(offsetof(instance_t, cell))
+			template<typename _field_type> decltype(auto) field(ull_t offset) const {
+				assert(offset + sizeof(_field_type) <= sizeof(_type));
+				return strided_view_t<_field_type>(m_data + offset, m_stride, m_size);
+			}
+			decltype(auto) begin() const { return iterator_t(m_data, m_stride); }
+			decltype(auto) end() const { return iterator_t(m_data + m_size * m_stride, m_stride); }
+		private:
+			strided_view_t(byte_t* data, ull_t stride, ull_t size) : m_data(data), m_stride(stride), m_size(size) {}
+		private:
+			byte_t* m_data = nullptr;
+			ull_t m_stride = sizeof(_type);
+			ull_t m_size = 0;
+		};
+		namespace priv {
+			/*
+				vector kernels of 4 byte elements, they return how many elements they handled and leave the tail to the scalar loop
+				scatters use masked stores and never read the target, which may be write combined gpu memory
+			*/
+#if defined(CW_SIMD_AVX2)
+			// every other 4 byte lane of the target, i.e. one field of 8 byte records
+			inline ull_t scatter_4_stride_8(const void* source, void* target, ull_t size) {
+				auto from = static_cast<const byte_t*>(source);
+				auto to = static_cast<byte_t*>(target);
+				auto mask = _mm256_setr_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+				auto low = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3), high = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+				ull_t i = 0;
+				for (; i + 8 <= size; i += 8) {
+					auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i * 4));
+					_mm256_maskstore_epi32(reinterpret_cast<int*>(to + i * 8), mask, _mm256_permutevar8x32_epi32(value, low));
+					_mm256_maskstore_epi32(reinterpret_cast<int*>(to + i * 8 + 32), mask, _mm256_permutevar8x32_epi32(value, high));
+				}
+				return i;
+			}
+			inline ull_t fill_4_stride_8(std::int32_t value, void* target, ull_t size) {
+				auto to = static_cast<byte_t*>(target);
+				auto mask = _mm256_setr_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+				auto values = _mm256_set1_epi32(value);
+				ull_t i = 0;
+				for (; i + 4 <= size; i += 4) _mm256_maskstore_epi32(reinterpret_cast<int*>(to + i * 8), mask, values);
+				return i;
+			}
+			// any stride below 2 GiB / 7
+			inline ull_t gather_4(const void* source, ull_t stride, void* target, ull_t size) {
+				if (stride * 7 > 0x7fffffff) return 0;
+				auto from = static_cast<const byte_t*>(source);
+				auto to = static_cast<byte_t*>(target);
+				auto s = static_cast<int>(stride);
+				auto index = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+				ull_t i = 0;
+				for (; i + 8 <= size; i += 8) {
+					auto value = _mm256_i32gather_epi32(reinterpret_cast<const int*>(from + i * stride), index, 1);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i * 4), value);
+				}
+				return i;
+			}
+#elif defined(CW_SIMD_SSE2)
+			// two 16 byte loads hold four fields in their even lanes, the last one reads 4 bytes ahead of element i + 3, so element i + 4 has to exist
+			inline ull_t gather_4(const void* source, ull_t stride, void* target, ull_t size) {
+				if (stride != 8) return 0;
+				auto from = static_cast<const byte_t*>(source);
+				auto to = static_cast<byte_t*>(target);
+				ull_t i = 0;
+				for (; i + 4 < size; i += 4) {
+					auto a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i * 8)));
+					auto b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i * 8 + 16)));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(to + i * 4), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+				}
+				return i;
+			}
+#endif
+		}
+		namespace func {
+			// contiguous source into the elements of target, aos <- soa
+			template<typename _type> void scatter(const _type* source, strided_view_t<_type> const& target) {
+				if (target.empty()) return;
+				if (target.is_contiguous()) { memcpy(target.data(), source, sizeof(_type) * target.size()); return; }
+				ull_t i = 0;
+#if defined(CW_SIMD_AVX2)
+				if constexpr (sizeof(_type) == 4) if (target.stride() == 8) i = priv::scatter_4_stride_8(source, target.data(), target.size());
+#endif
+				for (; i < target.size(); ++i) memcpy(target.address(i), source + i, sizeof(_type));
+			}
+			// elements of source into contiguous target, soa <- aos
+			template<typename _type> void gather(strided_view_t<_type> const& source, _type* target) {
+				if (source.empty()) return;
+				if (source.is_contiguous()) { memcpy(target, source.data(), sizeof(_type) * source.size()); return; }
+				ull_t i = 0;
+#if defined(CW_SIMD_AVX2) || defined(CW_SIMD_SSE2)
+				if constexpr (sizeof(_type) == 4) i = priv::gather_4(source.data(), source.stride(), target, source.size());
+#endif
+				for (; i < source.size(); ++i) memcpy(target + i, source.address(i), sizeof(_type));
+			}
+			template<typename _type> void copy(strided_view_t<_type> const& source, strided_view_t<_type> const& target) {
+				assert(source.size() == target.size());
+				if (source.is_contiguous()) { if (!source.empty()) scatter(static_cast<const _type*>(source.data()), target); return; }
+				if (target.is_contiguous()) { if (!target.empty()) gather(source, static_cast<_type*>(target.data())); return; }
+				for (ull_t i = 0; i < source.size(); ++i) memcpy(target.address(i), source.address(i), sizeof(_type));
+			}
+			template<typename _type> void fill(strided_view_t<_type> const& target, _type const& value) {
+				ull_t i = 0;
+#if defined(CW_SIMD_AVX2)
+				if constexpr (sizeof(_type) == 4) {
+					std::int32_t bits;
+					memcpy(&bits, &value, sizeof(bits));
+					if (target.stride() == 8) i = priv::fill_4_stride_8(bits, target.data(), target.size());
+				}
+#endif
+				for (; i < target.size(); ++i) memcpy(target.address(i), &value, sizeof(_type));
+			}
+			// first, first + 1, ... into the elements of target
+			template<typename _type> void iota(strided_view_t<_type> const& target, _type first) {
+				static_assert(std::is_arithmetic_v<_type>, "iota counts with arithmetic types");
+				for (ull_t i = 0; i < target.size(); ++i, ++first) memcpy(target.address(i), &first, sizeof(_type));
+			}
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "./integer.hpp"
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace cw {
+	namespace core {
+		class thread_pool_t {
+		public:
+			thread_pool_t(ull_t count = std::thread::hardware_concurrency()) : m_stop(false) {
+				if (count == 0) count = 1;
+				for (ull_t i = 0; i < count; ++i) m_threads.emplace_back([this, i]() { work(i); });
+			}
+			thread_pool_t(thread_pool_t const&) = delete;
+			thread_pool_t& operator=(thread_pool_t const&) = delete;
+			~thread_pool_t() {
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_condition.notify_all();
+				for (auto& iter : m_threads) iter.join();
+			}
+
+			template<typename _func_type>
+			decltype(auto) submit(_func_type&& func) {
+				using result_type = std::invoke_result_t<_func_type>;
+				auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<_func_type>(func));
+				auto result = task->get_future();
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_tasks.push([task]() { (*task)(); });
+				}
+				m_condition.notify_one();
+				return result;
+			}
+			/*
+				func(index) or func(index, worker) for index in [0, count), blocks until every index is done
+				worker is the index of the worker running func, called from a worker of this pool every index runs on the caller,
+				so waiting for the others can't take the last free worker
+			*/
+			template<typename _func_type>
+			decltype(auto) parallel_for(ull_t count, _func_type&& func) {
+				auto call = [&func](ull_t index, ull_t worker) {
+					if constexpr (std::is_invocable_v<_func_type&, ull_t, ull_t>) func(index, worker);
+					else func(index);
+				};
+				if (m_thread_pool == this) {
+					for (ull_t i = 0; i < count; ++i) call(i, m_thread_index.value());
+					return *this;
+				}
+				std::vector<std::future<void>> futures;
+				futures.reserve(count);
+				for (ull_t i = 0; i < count; ++i) futures.push_back(submit([&call, i]() { call(i, m_thread_index.value()); }));
+				for (auto& iter : futures) iter.get();
+				return *this;
+			}
+			decltype(auto) size() const { return static_cast<ull_t>(m_threads.size()); }
+			// index of the calling worker inside its pool, std::nullopt when called outside a pool
+			static decltype(auto) thread_index() { return m_thread_index; }
+		private:
+			void work(ull_t index) {
+				m_thread_index = index;
+				m_thread_pool = this;
+				while (true) {
+					std::function<void()> task;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+						if (m_stop && m_tasks.empty()) return;
+						task = std::move(m_tasks.front());
+						m_tasks.pop();
+					}
+					task();
+				}
+			}
+		private:
+			std::vector<std::thread> m_threads;
+			std::queue<std::function<void()>> m_tasks;
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			bool m_stop;
+			inline static thread_local std::optional<ull_t> m_thread_index = std::nullopt;
+			inline static thread_local thread_pool_t const* m_thread_pool = nullptr; // the pool of the calling worker
+		};
+	}
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "./integer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+	scoped cpu trace zones, exported as chrome trace json (chrome://tracing, ui.perfetto.dev)
+		CW_TRACE_ZONE("name");	// records the enclosing scope, name must outlive the trace (string literal)
+	zones are only compiled in when CW_CONFIG_ENABLE_TRACE is defined, otherwise the macro expands to nothing
+	every thread writes into its own ring buffer, the oldest zones are overwritten once it is full
+*/
+
+namespace cw {
+	namespace core {
+		struct trace_event_t {
+			const char* name = nullptr;
+			std::uint64_t begin = 0; // nanoseconds since the tracer was created
+			std::uint64_t end = 0;
+		};
+		// single writer (the owning thread), read by the exporter without locking, only the writer stores m_head and only readers store m_tail
+		// every slot is a seqlock : its sequence is odd while the writer fills it, a copy is kept when the sequence was even and unchanged around it
+		class trace_buffer_t {
+		public:
+			trace_buffer_t(ull_t thread_id, ull_t capacity) : m_thread_id(thread_id), m_slots(capacity) {}
+			void push(trace_event_t const& event) {
+				auto head = m_head.load(std::memory_order_relaxed);
+				auto& slot = m_slots[head % m_slots.size()];
+				slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				slot.name.store(event.name, std::memory_order_relaxed);
+				slot.begin.store(event.begin, std::memory_order_relaxed);
+				slot.end.store(event.end, std::memory_order_relaxed);
+				slot.sequence.store(2 * head + 2, std::memory_order_release);
+				m_head.store(head + 1, std::memory_order_release);
+			}
+			// zones being written or overwritten while copying are dropped
+			decltype(auto) snapshot() const {
+				std::vector<trace_event_t> result;
+				auto head = m_head.load(std::memory_order_acquire);
+				auto first = (std::max)(head > m_slots.size() ? head - m_slots.size() : 0, m_tail.load(std::memory_order_acquire));
+				for (auto i = first; i < head; ++i) {
+					const auto& slot = m_slots[i % m_slots.size()];
+					auto sequence = slot.sequence.load(std::memory_order_acquire);
+					if (sequence != 2 * i + 2) continue;
+					trace_event_t event{ slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed) };
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+					result.push_back(event);
+				}
+				return result;
+			}
+			// moves the read cursor past every zone pushed so far, the writer keeps its head
+			void clear() { m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release); }
+			decltype(auto) thread_id() const { return m_thread_id; }
+		private:
+			struct slot_t {
+				std::atomic<ull_t> sequence{ 0 }; // 2 * index + 2 once the event of that index is written
+				std::atomic<const char*> name{ nullptr };
+				std::atomic<std::uint64_t> begin{ 0 };
+				std::atomic<std::uint64_t> end{ 0 };
+			};
+			ull_t m_thread_id;
+			std::vector<slot_t> m_slots;
+			std::atomic<ull_t> m_head{ 0 };
+			std::atomic<ull_t> m_tail{ 0 }; // zones before it were cleared
+		};
+		class tracer_t {
+		public:
+			static decltype(auto) instance() { static tracer_t tracer; return (tracer); }
+
+			decltype(auto) is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+			void set_enabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+			// capacity of the buffers of threads which record their first zone afterwards
+			void set_capacity(ull_t capacity) { m_capacity = capacity; }
+			decltype(auto) now() const { return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count()); }
+			decltype(auto) local() {
+				thread_local trace_buffer_t* buffer = nullptr;
+				if (buffer == nullptr) {
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_buffers.push_back(std::make_unique<trace_buffer_t>(m_buffers.size(), m_capacity));
+					buffer = m_buffers.back().get();
+				}
+				return (*buffer);
+			}
+			void clear() {
+				std::unique_lock<std::mutex> lock(m_mutex);
+				for (auto& iter : m_buffers) iter->clear();
+			}
+			// "X" (complete) events, timestamps in microseconds
+			decltype(auto) write_chrome_trace(std::string const& path) {
+				std::ofstream os(path, std::ios::out | std::ios::trunc);
+				if (!os.is_open()) { std::cerr << "can't open trace file \"" << path << "\"" << std::endl; return false; }
+				os << "{\"traceEvents\":[";
+				bool first = true;
+				std::unique_lock<std::mutex> lock(m_mutex);
+				for (const auto& buffer : m_buffers) {
+					for (const auto& iter : buffer->snapshot()) {
+						os << (first ? "\n" : ",\n");
+						first = false;
+						os << "{\"name\":\"" << iter.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id()
+							<< ",\"ts\":" << iter.begin / 1000 << "." << iter.begin % 1000 / 100
+							<< ",\"dur\":" << (iter.end - iter.begin) / 1000 << "." << (iter.end - iter.begin) % 1000 / 100 << "}";
+					}
+				}
+				os << "\n],\"displayTimeUnit\":\"ms\"}";
+				return os.good();
+			}
+		private:
+			tracer_t() : m_start(std::chrono::steady_clock::now()) {}
+		private:
+			std::chrono::steady_clock::time_point m_start;
+			std::atomic<bool> m_enabled{ true };
+			ull_t m_capacity = 1 << 16;
+			std::mutex m_mutex;
+			std::vector<std::unique_ptr<trace_buffer_t>> m_buffers; // never shrinks, so buffers outlive their threads
+		};
+		class trace_zone_t {
+		public:
+			trace_zone_t(const char* name) : m_name(name), m_begin(0), m_active(tracer_t::instance().is_enabled()) {
+				if (m_active) m_begin = tracer_t::instance().now();
+			}
+			trace_zone_t(trace_zone_t const&) = delete;
+			trace_zone_t& operator=(trace_zone_t const&) = delete;
+			~trace_zone_t() {
+				if (!m_active) return;
+				auto& tracer = tracer_t::instance();
+				tracer.local().push({ m_name, m_begin, tracer.now() });
+			}
+		private:
+			const char* m_name;
+			std::uint64_t m_begin;
+			bool m_active;
+		};
+	}
+}
+
+#define CW_TRACE_CONCAT_PRIV(a, b) a##b
+#define CW_TRACE_CONCAT(a, b) CW_TRACE_CONCAT_PRIV(a, b)
+#ifdef CW_CONFIG_ENABLE_TRACE
+#define CW_TRACE_ZONE(name) ::cw::core::trace_zone_t CW_TRACE_CONCAT(cw_trace_zone_, __COUNTER__)(name)
+#else
+#define CW_TRACE_ZONE(name) ((void)0)
+#endif
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "./vec2.hpp"
+#include "./vec3.hpp"
+#include "./vec4.hpp"
+#include "./simd.hpp"
+#include <cstdint>
+#include <numeric>
+
+/*
+	batch operations on arrays of vec2_t / vec3_t / vec4_t, e.g. distance fields or instance positions
+	an array of vectors is walked as its flat components, so vec2 and vec3 fill whole registers too :
+	per step the kernels take the least number of registers that holds whole vectors (a vec3 of float takes 3 sse registers, 4 vectors)
+	float and std::int32_t use avx2 or sse2, other types and the tails run the vector operators
+*/
+
+namespace cw {
+	namespace core {
+		namespace priv {
+			// the widest enabled register of _type
+			template<typename _type> struct simd_t { static constexpr bool enabled = false; };
+#if defined(CW_SIMD_AVX2)
+			template<> struct simd_t<float> {
+				using reg_t = __m256;
+				static constexpr bool enabled = true;
+				static constexpr ull_t width = 8;
+				static reg_t load(const float* data) noexcept { return _mm256_loadu_ps(data); }
+				static void store(float* data, reg_t value) noexcept { _mm256_storeu_ps(data, value); }
+				static reg_t add(reg_t a, reg_t b) noexcept { return _mm256_add_ps(a, b); }
+				static reg_t mul(reg_t a, reg_t b) noexcept { return _mm256_mul_ps(a, b); }
+				// one bit per lane
+				static int less(reg_t a, reg_t b) noexcept { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+				static int equal(reg_t a, reg_t b) noexcept { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+			};
+			template<> struct simd_t<std::int32_t> {
+				using reg_t = __m256i;
+				static constexpr bool enabled = true;
+				static constexpr ull_t width = 8;
+				static reg_t load(const std::int32_t* data) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)); }
+				static void store(std::int32_t* data, reg_t value) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), value); }
+				static reg_t add(reg_t a, reg_t b) noexcept { return _mm256_add_epi32(a, b); }
+				static reg_t mul(reg_t a, reg_t b) noexcept { return _mm256_mullo_epi32(a, b); }
+				static int less(reg_t a, reg_t b) noexcept { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a))); }
+				static int equal(reg_t a, reg_t b) noexcept { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+			};
+#elif defined(CW_SIMD_SSE2)
+			template<> struct simd_t<float> {
+				using reg_t = __m128;
+				static constexpr bool enabled = true;
+				static constexpr ull_t width = 4;
+				static reg_t load(const float* data) noexcept { return _mm_loadu_ps(data); }
+				static void store(float* data, reg_t value) noexcept { _mm_storeu_ps(data, value); }
+				static reg_t add(reg_t a, reg_t b) noexcept { return _mm_add_ps(a, b); }
+				static reg_t mul(reg_t a, reg_t b) noexcept { return _mm_mul_ps(a, b); }
+				static int less(reg_t a, reg_t b) noexcept { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+				static int equal(reg_t a, reg_t b) noexcept { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+			};
+			template<> struct simd_t<std::int32_t> {
+				using reg_t = __m128i;
+				static constexpr bool enabled = true;
+				static constexpr ull_t width = 4;
+				static reg_t load(const std::int32_t* data) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); }
+				static void store(std::int32_t* data, reg_t value) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(data), value); }
+				static reg_t add(reg_t a, reg_t b) noexcept { return _mm_add_epi32(a, b); }
+				static reg_t mul(reg_t a, reg_t b) noexcept { return mullo_epi32(a, b); }
+				static int less(reg_t a, reg_t b) noexcept { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(a, b))); }
+				static int equal(reg_t a, reg_t b) noexcept { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+			};
+#endif
+			// registers and vectors per step of the batch kernels
+			template<typename _type, ull_t _size>
+			struct simd_step_t {
+				static constexpr ull_t registers = std::lcm(simd_t<_type>::width, _size) / simd_t<_type>::width;
+				static constexpr ull_t vectors = registers * simd_t<_type>::width / _size;
+				// value repeated over the lanes of the step
+				static void spread(inner_vec_t<_type, _size> const& value, typename simd_t<_type>::reg_t* result) noexcept {
+					_type lanes[simd_t<_type>::width];
+					for (ull_t i = 0; i < registers; ++i) {
+						for (ull_t j = 0; j < simd_t<_type>::width; ++j) lanes[j] = value[(i * simd_t<_type>::width + j) % _size];
+						result[i] = simd_t<_type>::load(lanes);
+					}
+				}
+			};
+			template<typename _type, ull_t _size> inline const _type* lanes(const inner_vec_t<_type, _size>* data) noexcept { return reinterpret_cast<const _type*>(data); }
+			template<typename _type, ull_t _size> inline _type* lanes(inner_vec_t<_type, _size>* data) noexcept { return reinterpret_cast<_type*>(data); }
+			// bit i of mask is lane i of the step, result[k] is true when every lane of vector k is set
+			template<ull_t _size> inline void all_lanes(std::uint64_t mask, ull_t count, bool* result) noexcept {
+				constexpr std::uint64_t full = (std::uint64_t(1) << _size) - 1;
+				for (ull_t k = 0; k < count; ++k) result[k] = ((mask >> (k * _size)) & full) == full;
+			}
+		}
+		namespace func {
+			// result[i] = a[i] + b[i]
+			template<typename _type, ull_t _size>
+			void add(const priv::inner_vec_t<_type, _size>* a, const priv::inner_vec_t<_type, _size>* b, priv::inner_vec_t<_type, _size>* result, ull_t count) {
+				if constexpr (priv::simd_t<_type>::enabled) {
+					// lane wise, the vectors don't need to line up with the registers
+					static_assert(sizeof(priv::inner_vec_t<_type, _size>) == sizeof(_type) * _size);
+					using simd = priv::simd_t<_type>;
+					auto x = priv::lanes(a), y = priv::lanes(b);
+					auto z = priv::lanes(result);
+					ull_t lane = 0;
+					for (; lane + simd::width <= count * _size; lane += simd::width) simd::store(z + lane, simd::add(simd::load(x + lane), simd::load(y + lane)));
+					for (; lane < count * _size; ++lane) z[lane] = x[lane] + y[lane];
+				}
+				else {
+					for (ull_t i = 0; i < count; ++i) result[i] = a[i] + b[i];
+				}
+			}
+			// result[i] = source[i] * scale + offset, e.g. cell coordinates into positions
+			template<typename _type, ull_t _size>
+			void transform(const priv::inner_vec_t<_type, _size>* source, priv::inner_vec_t<_type, _size>* result, ull_t count, priv::inner_vec_t<_type, _size> const& scale, priv::inner_vec_t<_type, _size> const& offset) {
+				ull_t i = 0;
+				if constexpr (priv::simd_t<_type>::enabled) {
+					static_assert(sizeof(priv::inner_vec_t<_type, _size>) == sizeof(_type) * _size);
+					using simd = priv::simd_t<_type>;
+					using step = priv::simd_step_t<_type, _size>;
+					typename simd::reg_t scales[step::registers], offsets[step::registers];
+					step::spread(scale, scales);
+					step::spread(offset, offsets);
+					auto from = priv::lanes(source);
+					auto to = priv::lanes(result);
+					for (; i + step::vectors <= count; i += step::vectors) {
+						for (ull_t r = 0; r < step::registers; ++r) {
+							auto lane = i * _size + r * simd::width;
+							simd::store(to + lane, simd::add(simd::mul(simd::load(from + lane), scales[r]), offsets[r]));
+						}
+					}
+				}
+				for (; i < count; ++i) result[i] = source[i] * scale + offset;
+			}
+			// result[i] = columns[0] * source[i][0] + columns[1] * source[i][1] + ..., column major as glm
+			inline void transform(const priv::inner_vec_t<float, 4>(&columns)[4], const priv::inner_vec_t<float, 4>* source, priv::inner_vec_t<float, 4>* result, ull_t count) {
+#if defined(CW_SIMD_SSE2)
+				__m128 c[4] = { _mm_load_ps(columns[0].data()), _mm_load_ps(columns[1].data()), _mm_load_ps(columns[2].data()), _mm_load_ps(columns[3].data()) };
+				for (ull_t i = 0; i < count; ++i) {
+					auto v = _mm_load_ps(source[i].data());
+					auto sum = _mm_mul_ps(c[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+					sum = _mm_add_ps(sum, _mm_mul_ps(c[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+					sum = _mm_add_ps(sum, _mm_mul_ps(c[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+					sum = _mm_add_ps(sum, _mm_mul_ps(c[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+					_mm_store_ps(result[i].data(), sum);
+				}
+#else
+				for (ull_t i = 0; i < count; ++i) {
+					auto v = source[i];
+					result[i] = columns[0] * v[0] + columns[1] * v[1] + columns[2] * v[2] + columns[3] * v[3];
+				}
+#endif
+			}
+			// result[i] = a[i] < b[i], for every component as operator<
+			template<typename _type, ull_t _size>
+			void less(const priv::inner_vec_t<_type, _size>* a, const priv::inner_vec_t<_type, _size>* b, bool* result, ull_t count) {
+				ull_t i = 0;
+				if constexpr (priv::simd_t<_type>::enabled) {
+					using simd = priv::simd_t<_type>;
+					using step = priv::simd_step_t<_type, _size>;
+					auto x = priv::lanes(a), y = priv::lanes(b);
+					for (; i + step::vectors <= count; i += step::vectors) {
+						std::uint64_t mask = 0;
+						for (ull_t r = 0; r < step::registers; ++r) {
+							auto lane = i * _size + r * simd::width;
+							mask |= static_cast<std::uint64_t>(simd::less(simd::load(x + lane), simd::load(y + lane))) << (r * simd::width);
+						}
+						priv::all_lanes<_size>(mask, step::vectors, result + i);
+					}
+				}
+				for (; i < count; ++i) result[i] = a[i] < b[i];
+			}
+			// result[i] = a[i] == b[i]
+			template<typename _type, ull_t _size>
+			void equal(const priv::inner_vec_t<_type, _size>* a, const priv::inner_vec_t<_type, _size>* b, bool* result, ull_t count) {
+				ull_t i = 0;
+				if constexpr (priv::simd_t<_type>::enabled) {
+					using simd = priv::simd_t<_type>;
+					using step = priv::simd_step_t<_type, _size>;
+					auto x = priv::lanes(a), y = priv::lanes(b);
+					for (; i + step::vectors <= count; i += step::vectors) {
+						std::uint64_t mask = 0;
+						for (ull_t r = 0; r < step::registers; ++r) {
+							auto lane = i * _size + r * simd::width;
+							mask |= static_cast<std::uint64_t>(simd::equal(simd::load(x + lane), simd::load(y + lane))) << (r * simd::width);
+						}
+						priv::all_lanes<_size>(mask, step::vectors, result + i);
+					}
+				}
+				for (; i < count; ++i) result[i] = a[i] == b[i];
+			}
+		}
+	}
+}
@@ -50,10 +50,10 @@ namespace cw {
 				constexpr inline decltype(auto) operator*(const type& other) const noexcept { return inner_vec_t{ m_vec[0] * other, m_vec[1] * other }; }
 				constexpr inline decltype(auto) operator/(const type& other) const noexcept { return inner_vec_t{ m_vec[0] / other, m_vec[1] / other }; }
 
-				constexpr inline static friend decltype(auto) operator+(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other + vecn.m_vec[0],other + vecn.m_vec[1] }; }
-				constexpr inline static friend decltype(auto) operator-(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other - vecn.m_vec[0],other - vecn.m_vec[1] }; }
-				constexpr inline static friend decltype(auto) operator*(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other * vecn.m_vec[0],other * vecn.m_vec[1] }; }
-				constexpr inline static friend decltype(auto) operator/(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other / vecn.m_vec[0],other / vecn.m_vec[1] }; }
+				constexpr inline friend decltype(auto) operator+(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other + vecn.m_vec[0],other + vecn.m_vec[1] }; }
+				constexpr inline friend decltype(auto) operator-(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other - vecn.m_vec[0],other - vecn.m_vec[1] }; }
+				constexpr inline friend decltype(auto) operator*(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other * vecn.m_vec[0],other * vecn.m_vec[1] }; }
+				constexpr inline friend decltype(auto) operator/(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other / vecn.m_vec[0],other / vecn.m_vec[1] }; }
 
 				// operator : > >= < <= ==
 				constexpr inline decltype(auto) operator> (const inner_vec_t& other) const noexcept { return (m_vec[0] >  other.m_vec[0]) && (m_vec[1] >  other.m_vec[1]); }
@@ -70,12 +70,12 @@ namespace cw {
 				constexpr inline decltype(auto) operator==(const type& other) const noexcept { return (m_vec[0] == other) && (m_vec[1] == other); }
 				constexpr inline decltype(auto) operator!=(const type& other) const noexcept { return (m_vec[0] != other) || (m_vec[1] != other); }
 
-				constexpr inline static friend decltype(auto) operator> (const type& other,const inner_vec_t& vecn) noexcept { return (other >  vecn.m_vec[0]) && (other >  vecn.m_vec[1]); }
-				constexpr inline static friend decltype(auto) operator>=(const type& other,const inner_vec_t& vecn) noexcept { return (other >= vecn.m_vec[0]) && (other >= vecn.m_vec[1]); }
-				constexpr inline static friend decltype(auto) operator< (const type& other,const inner_vec_t& vecn) noexcept { return (other <  vecn.m_vec[0]) && (other <  vecn.m_vec[1]); }
-				constexpr inline static friend decltype(auto) operator<=(const type& other,const inner_vec_t& vecn) noexcept { return (other <= vecn.m_vec[0]) && (other <= vecn.m_vec[1]); }
-				constexpr inline static friend decltype(auto) operator==(const type& other,const inner_vec_t& vecn) noexcept { return (other == vecn.m_vec[0]) && (other == vecn.m_vec[1]); }
-				constexpr inline static friend decltype(auto) operator!=(const type& other,const inner_vec_t& vecn) noexcept { return (other != vecn.m_vec[0]) || (other != vecn.m_vec[1]); }
+				constexpr inline friend decltype(auto) operator> (const type& other,const inner_vec_t& vecn) noexcept { return (other >  vecn.m_vec[0]) && (other >  vecn.m_vec[1]); }
+				constexpr inline friend decltype(auto) operator>=(const type& other,const inner_vec_t& vecn) noexcept { return (other >= vecn.m_vec[0]) && (other >= vecn.m_vec[1]); }
+				constexpr inline friend decltype(auto) operator< (const type& other,const inner_vec_t& vecn) noexcept { return (other <  vecn.m_vec[0]) && (other <  vecn.m_vec[1]); }
+				constexpr inline friend decltype(auto) operator<=(const type& other,const inner_vec_t& vecn) noexcept { return (other <= vecn.m_vec[0]) && (other <= vecn.m_vec[1]); }
+				constexpr inline friend decltype(auto) operator==(const type& other,const inner_vec_t& vecn) noexcept { return (other == vecn.m_vec[0]) && (other == vecn.m_vec[1]); }
+				constexpr inline friend decltype(auto) operator!=(const type& other,const inner_vec_t& vecn) noexcept { return (other != vecn.m_vec[0]) || (other != vecn.m_vec[1]); }
 
 			public:
 				type m_vec[2];
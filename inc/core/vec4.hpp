@@ -0,0 +1,91 @@
+#pragma once
+
+#include "./priv/vec_lanes.hpp"
+#include "./vec3.hpp"
+
+namespace cw {
+	namespace core {
+		namespace priv {
+			// arithmetic and comparisons go through vec_lanes_t, which keeps float and std::int32_t in one sse register
+			template<typename _type>
+			struct inner_vec_t<_type, 4> {
+				using type = _type;
+				using lanes_t = vec_lanes_t<type, 4>;
+				static_assert(std::is_reference_v<type> == false);
+
+				constexpr inner_vec_t() noexcept :m_vec{} {}
+				constexpr inner_vec_t(const type& v0, const type& v1, const type& v2, const type& v3) noexcept :m_vec{ v0,v1,v2,v3 } {}
+				constexpr inner_vec_t(const type& other) noexcept : m_vec{ other, other, other, other } {}
+				constexpr inner_vec_t(const inner_vec_t<type, 3>& xyz, const type& w) noexcept : m_vec{ xyz[0], xyz[1], xyz[2], w } {}
+				constexpr inner_vec_t(const inner_vec_t& other) noexcept : m_vec{ other.m_vec[0], other.m_vec[1], other.m_vec[2], other.m_vec[3] } {}
+
+				constexpr inline ull_t size() const noexcept { return 4; }
+				constexpr inline static ull_t size_s() noexcept { return 4; }
+				constexpr inline const type* data() const noexcept { return m_vec; }
+				constexpr inline type* data() noexcept { return m_vec; }
+				constexpr inline decltype(auto) to_vec() const { return inner_vec_t{ *this }; }
+
+				// operator : [] = - ==
+				constexpr inline decltype(auto) operator[](ull_t index) const noexcept { return m_vec[index]; }
+				constexpr inline decltype(auto) operator[](ull_t index) noexcept { return m_vec[index]; }
+				constexpr inline decltype(auto) operator=(const inner_vec_t& other) noexcept { for (ull_t i = 0; i < 4; ++i) m_vec[i] = other.m_vec[i]; return *this; }
+				constexpr inline decltype(auto) operator=(const type& other) noexcept { for (ull_t i = 0; i < 4; ++i) m_vec[i] = other; return *this; }
+				constexpr inline decltype(auto) operator-() const noexcept { return inner_vec_t{ -m_vec[0], -m_vec[1], -m_vec[2], -m_vec[3] }; }
+
+				// operator : += -= *= /=
+				constexpr inline decltype(auto) operator+=(const inner_vec_t& other) noexcept { lanes_t::add(m_vec, m_vec, other.m_vec); return *this; }
+				constexpr inline decltype(auto) operator-=(const inner_vec_t& other) noexcept { lanes_t::sub(m_vec, m_vec, other.m_vec); return *this; }
+				constexpr inline decltype(auto) operator*=(const inner_vec_t& other) noexcept { lanes_t::mul(m_vec, m_vec, other.m_vec); return *this; }
+				constexpr inline decltype(auto) operator/=(const inner_vec_t& other) noexcept { lanes_t::div(m_vec, m_vec, other.m_vec); return *this; }
+
+				constexpr inline decltype(auto) operator+=(const type& other) noexcept { return *this += inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator-=(const type& other) noexcept { return *this -= inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator*=(const type& other) noexcept { return *this *= inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator/=(const type& other) noexcept { return *this /= inner_vec_t{ other }; }
+
+				// operator : + - * /
+				constexpr inline decltype(auto) operator+(const inner_vec_t& other) const noexcept { inner_vec_t result; lanes_t::add(result.m_vec, m_vec, other.m_vec); return result; }
+				constexpr inline decltype(auto) operator-(const inner_vec_t& other) const noexcept { inner_vec_t result; lanes_t::sub(result.m_vec, m_vec, other.m_vec); return result; }
+				constexpr inline decltype(auto) operator*(const inner_vec_t& other) const noexcept { inner_vec_t result; lanes_t::mul(result.m_vec, m_vec, other.m_vec); return result; }
+				constexpr inline decltype(auto) operator/(const inner_vec_t& other) const noexcept { inner_vec_t result; lanes_t::div(result.m_vec, m_vec, other.m_vec); return result; }
+
+				constexpr inline decltype(auto) operator+(const type& other) const noexcept { return *this + inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator-(const type& other) const noexcept { return *this - inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator*(const type& other) const noexcept { return *this * inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator/(const type& other) const noexcept { return *this / inner_vec_t{ other }; }
+
+				constexpr inline friend decltype(auto) operator+(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } + vecn; }
+				constexpr inline friend decltype(auto) operator-(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } - vecn; }
+				constexpr inline friend decltype(auto) operator*(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } * vecn; }
+				constexpr inline friend decltype(auto) operator/(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } / vecn; }
+
+				// operator : > >= < <= == , true when it holds for every component
+				constexpr inline decltype(auto) operator> (const inner_vec_t& other) const noexcept { return lanes_t::all_less(other.m_vec, m_vec); }
+				constexpr inline decltype(auto) operator>=(const inner_vec_t& other) const noexcept { return lanes_t::all_less_equal(other.m_vec, m_vec); }
+				constexpr inline decltype(auto) operator< (const inner_vec_t& other) const noexcept { return lanes_t::all_less(m_vec, other.m_vec); }
+				constexpr inline decltype(auto) operator<=(const inner_vec_t& other) const noexcept { return lanes_t::all_less_equal(m_vec, other.m_vec); }
+				constexpr inline decltype(auto) operator==(const inner_vec_t& other) const noexcept { return lanes_t::all_equal(m_vec, other.m_vec); }
+				constexpr inline decltype(auto) operator!=(const inner_vec_t& other) const noexcept { return !lanes_t::all_equal(m_vec, other.m_vec); }
+
+				constexpr inline decltype(auto) operator> (const type& other) const noexcept { return *this >  inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator>=(const type& other) const noexcept { return *this >= inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator< (const type& other) const noexcept { return *this <  inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator<=(const type& other) const noexcept { return *this <= inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator==(const type& other) const noexcept { return *this == inner_vec_t{ other }; }
+				constexpr inline decltype(auto) operator!=(const type& other) const noexcept { return *this != inner_vec_t{ other }; }
+
+				constexpr inline friend decltype(auto) operator> (const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } >  vecn; }
+				constexpr inline friend decltype(auto) operator>=(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } >= vecn; }
+				constexpr inline friend decltype(auto) operator< (const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } <  vecn; }
+				constexpr inline friend decltype(auto) operator<=(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } <= vecn; }
+				constexpr inline friend decltype(auto) operator==(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } == vecn; }
+				constexpr inline friend decltype(auto) operator!=(const type& other, const inner_vec_t& vecn) noexcept { return inner_vec_t{ other } != vecn; }
+
+			public:
+				alignas(lanes_t::alignment) type m_vec[4];
+			};
+		}
+		template<typename _type>
+		using vec4_t = priv::inner_vec_t<_type, 4>;
+	}
+}
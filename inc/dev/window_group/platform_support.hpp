@@ -4,3 +4,6 @@
 #ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
 #include "./priv/platform_support_win32.hpp"
 #endif
+#ifdef CW_CONFIG_USE_PLATFORM_XCB
+#include "./priv/platform_support_xcb.hpp"
+#endif
\ No newline at end of file
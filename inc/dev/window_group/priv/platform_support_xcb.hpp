@@ -0,0 +1,13 @@
+#pragma once
+
+#include <xcb/xcb.h>
+
+namespace cw {
+	namespace dev {
+		class window_group_t;
+		namespace priv {
+			xcb_connection_t* get_xcb_connection(window_group_t* group);
+			xcb_window_t get_xcb_window(window_group_t* group);
+		}
+	}
+}
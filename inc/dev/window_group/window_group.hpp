@@ -9,6 +9,8 @@
 #include <memory>
 #include <variant>
 #include <queue>
+#include <optional>
+#include <chrono>
 
 namespace cw {
 	namespace dev {
@@ -17,6 +19,7 @@ namespace cw {
 		using offset_t = core::offset2_t<core::s32_t>;
 		using extent_t = core::extent2_t<core::u32_t>;
 		using rect_t = core::rect_t<offset_t, extent_t>;
+		using time_point_t = std::chrono::steady_clock::time_point;
 
 		struct window_group_ci_t {
 			window_group_ci_t() noexcept : m_rect{ offset_t{200, 100}, extent_t{800, 600 } }, m_title{ L"ef-dev-window_group"s }{}
@@ -31,7 +34,7 @@ namespace cw {
 		};
 
 		enum class key_e {
-			e_w, e_a, e_s, e_d, e_left, e_right, e_up, e_down, e_space, e_r, e_f, e_null
+			e_w, e_a, e_s, e_d, e_left, e_right, e_up, e_down, e_space, e_r, e_f, e_i, e_j, e_k, e_l, e_z, e_x, e_null
 		};
 
 		inline decltype(auto) to_string(key_e key) {
@@ -47,6 +50,12 @@ namespace cw {
 			case key_e::e_space: return "SPACE"s;
 			case key_e::e_r: return "R"s;
 			case key_e::e_f: return "F"s;
+			case key_e::e_i: return "I"s;
+			case key_e::e_j: return "J"s;
+			case key_e::e_k: return "K"s;
+			case key_e::e_l: return "L"s;
+			case key_e::e_z: return "Z"s;
+			case key_e::e_x: return "X"s;
 			}
 			return "NULL"s;
 		}
@@ -75,6 +84,10 @@ namespace cw {
 			bool is_active() { if (m_is_active) return true; kill_active_priv(); return false; }
 			//virtual bool is_draw_able() = 0;
 			void kill_active() { m_is_active = false; }
+			// the extent to render offscreen at when no window was opened, e.g. without a display
+			virtual std::optional<extent_t> headless() const { return std::nullopt; }
+			// the time of the last update(), a scripted group replays on its own clock
+			virtual time_point_t now() const { return std::chrono::steady_clock::now(); }
 		protected:
 			window_group_t() :m_is_active{ false } {}
 			virtual void kill_active_priv() = 0;
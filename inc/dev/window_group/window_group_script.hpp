@@ -0,0 +1,45 @@
+#pragma once
+
+#include "./window_group.hpp"
+
+#include <istream>
+#include <vector>
+
+namespace cw {
+	namespace dev {
+		// an event_t sent time after the group was built
+		struct script_event_t {
+			std::chrono::milliseconds time;
+			event_t event;
+		};
+		enum class replay_e {
+			e_real_time,	// events are sent when their time has come
+			e_max_speed,	// every update() moves the clock frame_time on, runs are repeatable
+			e_null
+		};
+		struct window_group_script_ci_t {
+			extent_t extent = { 800, 600 };
+			std::vector<script_event_t> events; // in time order, the group closes on e_close
+			replay_e replay = replay_e::e_real_time;
+			std::chrono::microseconds frame_time = std::chrono::microseconds(16667);
+			inline decltype(auto) set_extent(const extent_t& extent) { this->extent = extent; return *this; }
+			inline decltype(auto) set_events(const std::vector<script_event_t>& events) { this->events = events; return *this; }
+			inline decltype(auto) set_replay(replay_e replay) { this->replay = replay; return *this; }
+			inline decltype(auto) set_frame_time(std::chrono::microseconds frame_time) { this->frame_time = frame_time; return *this; }
+		};
+		namespace func {
+			/*
+				one event per line, empty lines and lines starting with # are skipped :
+					0 keydown SPACE
+					500 keyup UP
+					1200 resize 640x480
+					5000 close
+				the time is in milliseconds, keys are named as to_string(key_e)
+			*/
+			std::optional<std::vector<script_event_t>> parse_script(std::istream& is);
+			std::optional<std::vector<script_event_t>> load_script(const std::string& path);
+		}
+		// opens no window, the events come from the script
+		std::unique_ptr<window_group_t> build_script_window_group(const window_group_script_ci_t& create_info);
+	}
+}
@@ -2,6 +2,7 @@
 
 #include "./device.hpp"
 #include "./../../core/memory.hpp"
+#include <tuple>
 
 namespace cw {
 	namespace graphic {
@@ -12,11 +13,13 @@ namespace cw {
 				vk::MemoryPropertyFlags memory_flags;
 				vk::DeviceSize byte = 0;
 				std::optional<core::memory_view_t> memory_view;
+				std::optional<memory_intent_e> intent; // replaces memory_flags when set
 				decltype(auto) set_device(device_t const* device) { this->device = device; return *this; }
 				decltype(auto) set_usage_flags(vk::BufferUsageFlags const& usage_flags) { this->usage_flags = usage_flags; return *this; }
 				decltype(auto) set_memory_flags(vk::MemoryPropertyFlags const& memory_flags) { this->memory_flags = memory_flags; return *this; }
 				decltype(auto) set_byte(vk::DeviceSize const& byte) { this->byte = byte; return *this; }
 				decltype(auto) set_memory_view(core::memory_view_t const& memory_view, bool set_byte = true) { this->memory_view = memory_view; if(set_byte) this->byte = memory_view.byte(); return *this; }
+				decltype(auto) set_intent(memory_intent_e intent) { this->intent = intent; return *this; }
 			};
 			class buffer_t {
 			private:
@@ -29,6 +32,9 @@ namespace cw {
 				vk::DeviceMemory m_memory;
 			public:
 				decltype(auto) byte() const { return m_byte; }
+				// flags of the memory type actually chosen
+				decltype(auto) memory_flags() const { return m_memory_flags; }
+				decltype(auto) is_host_visible() const { return static_cast<bool>(m_memory_flags & vk::MemoryPropertyFlagBits::eHostVisible); }
 				
 				decltype(auto) map(std::optional<vk::DeviceSize> const& byte = std::nullopt, vk::DeviceSize const& offset = 0) const {
 					auto mapped_size = byte.has_value() ? byte.value() : m_byte;
@@ -84,7 +90,10 @@ namespace cw {
 					return result;
 				}
 
+				// the replaced buffer may still be used by a frame in flight, it is retired rather than destroyed
 				decltype(auto) operator=(buffer_t&& other) noexcept {
+					if (this == &other) return *this;
+					retire();
 					std::swap(m_device, other.m_device);
 					std::swap(m_usage_flags, other.m_usage_flags);
 					std::swap(m_memory_flags, other.m_memory_flags);
@@ -94,8 +103,17 @@ namespace cw {
 					return *this;
 				}
 
-				decltype(auto) operator=(std::nullptr_t) noexcept {
-					this->~buffer_t();
+				decltype(auto) operator=(std::nullptr_t) noexcept { return retire(); }
+				// the device destroys the buffer once the frames in flight have completed, only the destructor destroys right away
+				decltype(auto) retire() {
+					if (m_device) {
+						m_device->defer_destroy(m_buffer);
+						m_device->defer_destroy(m_memory);
+					}
+					m_buffer = nullptr;
+					m_memory = nullptr;
+					m_device = nullptr;
+					m_byte = 0;
 					return *this;
 				}
 
@@ -115,6 +133,7 @@ namespace cw {
 				}
 				buffer_t(buffer_ci_t const& ci) : m_device(ci.device), m_usage_flags(ci.usage_flags), m_memory_flags(ci.memory_flags), m_byte(ci.byte) {
 					assert(m_device);
+					if (ci.intent.has_value() && ci.memory_view.has_value()) m_usage_flags |= vk::BufferUsageFlagBits::eTransferDst;
 					m_buffer = vk::Device(*m_device).createBuffer(
 						vk::BufferCreateInfo()
 						.setUsage(m_usage_flags)
@@ -123,18 +142,30 @@ namespace cw {
 					);
 
 					auto memory_requirement = vk::Device(*m_device).getBufferMemoryRequirements(m_buffer);
-					m_memory = vk::Device(*m_device).allocateMemory(
-						vk::MemoryAllocateInfo()
-						.setAllocationSize(memory_requirement.size)
-						.setMemoryTypeIndex(m_device->find_memory_index(memory_requirement.memoryTypeBits, m_memory_flags))
-					);
+					auto type = std::uint32_t(0);
+					if (ci.intent.has_value()) std::tie(m_memory, type) = m_device->allocate_memory_for(memory_requirement, ci.intent.value(), m_byte);
+					else {
+						type = m_device->find_memory_index(memory_requirement.memoryTypeBits, m_memory_flags);
+						m_memory = m_device->allocate_memory(memory_requirement, type, m_byte);
+					}
+					m_memory_flags = m_device->memory_type_flags(type);
 					vk::Device(*m_device).bindBufferMemory(m_buffer, m_memory, 0);
 
-					if (ci.memory_view.has_value()) copy_from(ci.memory_view.value());
+					if (!ci.memory_view.has_value()) return;
+					if (is_host_visible()) copy_from(ci.memory_view.value());
+					else {
+						copy_from(buffer_t(
+							buffer_ci_t()
+							.set_device(m_device)
+							.set_usage_flags(vk::BufferUsageFlagBits::eTransferSrc)
+							.set_intent(memory_intent_e::e_staging)
+							.set_memory_view(ci.memory_view.value())
+						));
+					}
 				}
 				~buffer_t() {
 					if (m_device) {
-						vk::Device(*m_device).freeMemory(m_memory);
+						m_device->free_memory(m_memory);
 						vk::Device(*m_device).destroyBuffer(m_buffer);
 						m_memory = nullptr;
 						m_buffer = nullptr;
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "./device.hpp"
+#include "./../../core/memory.hpp"
+#include <functional>
+
+namespace cw {
+	namespace graphic {
+		namespace vulkan {
+			// a rendered frame copied back to host memory, pixels are only valid inside the capture callback
+			struct capture_frame_t {
+				std::uint64_t frame = 0;
+				vk::Extent2D extent;
+				vk::Format format = vk::Format::eUndefined;
+				core::memory_view_t pixels;
+			};
+			using capture_func_t = std::function<void(capture_frame_t const&)>;
+
+			namespace func {
+				inline decltype(auto) is_capture_format(vk::Format format) {
+					switch (format) {
+					case vk::Format::eR8G8B8A8Unorm:
+					case vk::Format::eR8G8B8A8Srgb:
+					case vk::Format::eB8G8R8A8Unorm:
+					case vk::Format::eB8G8R8A8Srgb: return true;
+					}
+					return false;
+				}
+				inline decltype(auto) is_bgra_format(vk::Format format) { return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb; }
+				// binary ppm (P6), alpha is dropped
+				inline decltype(auto) write_capture_ppm(std::string const& path, capture_frame_t const& frame) {
+					assert(is_capture_format(frame.format));
+					std::ofstream os(path, std::ios::binary | std::ios::out | std::ios::trunc);
+					if (!os.is_open()) { std::cerr << "can't open capture file \"" << path << "\"" << std::endl; return false; }
+					os << "P6\n" << frame.extent.width << " " << frame.extent.height << "\n255\n";
+					auto pixels = static_cast<const std::uint8_t*>(frame.pixels.data());
+					auto bgra = is_bgra_format(frame.format);
+					std::vector<std::uint8_t> row(static_cast<std::size_t>(frame.extent.width) * 3);
+					for (std::uint32_t y = 0; y < frame.extent.height; ++y) {
+						for (std::uint32_t x = 0; x < frame.extent.width; ++x) {
+							auto src = pixels + (static_cast<std::size_t>(y) * frame.extent.width + x) * 4;
+							row[x * 3 + 0] = bgra ? src[2] : src[0];
+							row[x * 3 + 1] = src[1];
+							row[x * 3 + 2] = bgra ? src[0] : src[2];
+						}
+						os.write(reinterpret_cast<const char*>(row.data()), row.size());
+					}
+					return os.good();
+				}
+				// count of pixels which differ from a golden ppm written by write_capture_ppm, std::nullopt when it can't be compared
+				inline decltype(auto) compare_capture_ppm(std::string const& path, capture_frame_t const& frame) {
+					std::optional<core::ull_t> result = std::nullopt;
+					std::ifstream is(path, std::ios::binary | std::ios::in);
+					std::string magic;
+					std::uint32_t width = 0, height = 0, max_value = 0;
+					if (!(is >> magic >> width >> height >> max_value) || magic != "P6" || max_value != 255) { std::cerr << "can't read golden image \"" << path << "\"" << std::endl; return result; }
+					if (width != frame.extent.width || height != frame.extent.height) return result;
+					is.get();
+					std::vector<std::uint8_t> golden(static_cast<std::size_t>(width) * height * 3);
+					if (!is.read(reinterpret_cast<char*>(golden.data()), golden.size())) return result;
+					auto pixels = static_cast<const std::uint8_t*>(frame.pixels.data());
+					auto bgra = is_bgra_format(frame.format);
+					core::ull_t count = 0;
+					for (std::size_t i = 0; i < static_cast<std::size_t>(width) * height; ++i) {
+						auto src = pixels + i * 4;
+						auto dst = golden.data() + i * 3;
+						if ((bgra ? src[2] : src[0]) != dst[0] || src[1] != dst[1] || (bgra ? src[0] : src[2]) != dst[2]) ++count;
+					}
+					result = count;
+					return result;
+				}
+			}
+		}
+	}
+}
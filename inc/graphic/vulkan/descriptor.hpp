@@ -0,0 +1,296 @@
+#pragma once
+
+#include "./device.hpp"
+#include <deque>
+#include <vector>
+
+namespace cw {
+	namespace graphic {
+		namespace vulkan {
+			struct descriptor_allocator_ci_t {
+				const device_t* device = nullptr;
+				// descriptors of each type per set, a pool of n sets holds n * ratio descriptors of the type
+				std::vector<std::pair<vk::DescriptorType, float>> ratios = {
+					{ vk::DescriptorType::eUniformBuffer, 2.0f },
+					{ vk::DescriptorType::eStorageBuffer, 4.0f },
+					{ vk::DescriptorType::eCombinedImageSampler, 2.0f }
+				};
+				std::uint32_t set_count = 16; // sets of the first pool, every new pool doubles it up to max_set_count
+				std::uint32_t max_set_count = 4096;
+				decltype(auto) set_device(device_t const* device) { this->device = device; return *this; }
+				decltype(auto) set_ratios(std::vector<std::pair<vk::DescriptorType, float>> const& ratios) { this->ratios = ratios; return *this; }
+				decltype(auto) set_set_count(std::uint32_t set_count) { this->set_count = set_count; return *this; }
+				decltype(auto) set_max_set_count(std::uint32_t max_set_count) { this->max_set_count = max_set_count; return *this; }
+			};
+			/*
+				descriptor sets of any layout, a new pool is created whenever the current one runs out
+				sets are never freed one by one, reset() recycles every pool at once
+			*/
+			class descriptor_allocator_t {
+			public:
+				descriptor_allocator_t(descriptor_allocator_ci_t const& ci) : m_ci(ci), m_set_count(ci.set_count) { assert(m_ci.device && m_ci.set_count > 0); }
+				descriptor_allocator_t(descriptor_allocator_t const&) = delete;
+				descriptor_allocator_t& operator=(descriptor_allocator_t const&) = delete;
+				descriptor_allocator_t(descriptor_allocator_t&& other) noexcept : m_ci(other.m_ci) { swap(other); }
+				descriptor_allocator_t& operator=(descriptor_allocator_t&& other) noexcept { swap(other); return *this; }
+				~descriptor_allocator_t() { clean(); }
+
+				decltype(auto) allocate(vk::DescriptorSetLayout layout) {
+					vk::DescriptorSet result;
+					if (!m_current) m_current = grab();
+					auto ai = vk::DescriptorSetAllocateInfo().setDescriptorPool(m_current).setDescriptorSetCount(1).setPSetLayouts(&layout);
+					auto status = vk::Device(*m_ci.device).allocateDescriptorSets(&ai, &result);
+					if (status == vk::Result::eErrorOutOfPoolMemory || status == vk::Result::eErrorFragmentedPool) {
+						m_used.push_back(m_current);
+						m_current = grab();
+						ai.setDescriptorPool(m_current);
+						status = vk::Device(*m_ci.device).allocateDescriptorSets(&ai, &result);
+					}
+					if (status != vk::Result::eSuccess) std::cerr << "can't allocate descriptor set : " << vk::to_string(status) << std::endl;
+					assert(status == vk::Result::eSuccess);
+					return result;
+				}
+				// every set allocated so far becomes invalid, the gpu must be done with them
+				void reset() {
+					if (m_current) m_used.push_back(m_current);
+					m_current = nullptr;
+					for (const auto& iter : m_used) {
+						vk::Device(*m_ci.device).resetDescriptorPool(iter);
+						m_ready.push_back(iter);
+					}
+					m_used.clear();
+				}
+				decltype(auto) pool_count() const { return static_cast<std::uint32_t>(m_used.size() + m_ready.size() + (m_current ? 1 : 0)); }
+			private:
+				vk::DescriptorPool grab() {
+					if (!m_ready.empty()) {
+						auto result = m_ready.back();
+						m_ready.pop_back();
+						return result;
+					}
+					std::vector<vk::DescriptorPoolSize> pool_sizes;
+					for (const auto& iter : m_ci.ratios) {
+						pool_sizes.push_back(
+							vk::DescriptorPoolSize()
+							.setType(iter.first)
+							.setDescriptorCount((std::max)(1u, static_cast<std::uint32_t>(iter.second * m_set_count)))
+						);
+					}
+					auto result = vk::Device(*m_ci.device).createDescriptorPool(
+						vk::DescriptorPoolCreateInfo()
+						.setPoolSizeCount(pool_sizes.size())
+						.setPPoolSizes(pool_sizes.data())
+						.setMaxSets(m_set_count)
+					);
+					m_set_count = (std::min)(m_set_count * 2, m_ci.max_set_count);
+					return result;
+				}
+				void swap(descriptor_allocator_t& other) {
+					std::swap(m_ci, other.m_ci);
+					std::swap(m_set_count, other.m_set_count);
+					std::swap(m_current, other.m_current);
+					std::swap(m_used, other.m_used);
+					std::swap(m_ready, other.m_ready);
+				}
+				// the sets may still be bound by frames in flight, the pools go through the device's deletion queue
+				void clean() {
+					if (!m_ci.device) return;
+					if (m_current) m_used.push_back(m_current);
+					m_current = nullptr;
+					for (const auto& iter : m_used) m_ci.device->defer_destroy(iter);
+					for (const auto& iter : m_ready) m_ci.device->defer_destroy(iter);
+					m_used.clear();
+					m_ready.clear();
+				}
+			private:
+				descriptor_allocator_ci_t m_ci;
+				std::uint32_t m_set_count = 0;
+				vk::DescriptorPool m_current;
+				std::vector<vk::DescriptorPool> m_used;
+				std::vector<vk::DescriptorPool> m_ready;
+			};
+
+			// one allocator per frame in flight, the sets of a frame are recycled when the frame comes around again
+			class frame_descriptor_allocator_t {
+			public:
+				frame_descriptor_allocator_t(descriptor_allocator_ci_t const& ci, std::uint32_t frame_count) {
+					assert(frame_count > 0);
+					for (std::uint32_t i = 0; i < frame_count; ++i) m_allocators.emplace_back(ci);
+				}
+				// call once the fence of the frame has signaled
+				decltype(auto) begin_frame(std::uint32_t frame) {
+					auto& allocator = m_allocators[frame % m_allocators.size()];
+					allocator.reset();
+					return (allocator);
+				}
+				decltype(auto) frame_count() const { return static_cast<std::uint32_t>(m_allocators.size()); }
+			private:
+				std::vector<descriptor_allocator_t> m_allocators;
+			};
+
+			// collects writes for one set, the infos stay valid until update()
+			class descriptor_writer_t {
+			public:
+				decltype(auto) write_buffer(std::uint32_t binding, vk::DescriptorType type, vk::Buffer buffer, vk::DeviceSize range = VK_WHOLE_SIZE, vk::DeviceSize offset = 0, std::uint32_t array_element = 0) {
+					m_buffer_infos.push_back(vk::DescriptorBufferInfo().setBuffer(buffer).setOffset(offset).setRange(range));
+					m_writes.push_back(
+						vk::WriteDescriptorSet()
+						.setDescriptorType(type)
+						.setDescriptorCount(1)
+						.setDstBinding(binding)
+						.setDstArrayElement(array_element)
+						.setPBufferInfo(&m_buffer_infos.back())
+					);
+					return *this;
+				}
+				decltype(auto) write_image(std::uint32_t binding, vk::DescriptorType type, vk::ImageView view, vk::ImageLayout layout, vk::Sampler sampler = nullptr, std::uint32_t array_element = 0) {
+					m_image_infos.push_back(vk::DescriptorImageInfo().setImageView(view).setImageLayout(layout).setSampler(sampler));
+					m_writes.push_back(
+						vk::WriteDescriptorSet()
+						.setDescriptorType(type)
+						.setDescriptorCount(1)
+						.setDstBinding(binding)
+						.setDstArrayElement(array_element)
+						.setPImageInfo(&m_image_infos.back())
+					);
+					return *this;
+				}
+				decltype(auto) update(device_t const* device, vk::DescriptorSet set) {
+					for (auto& iter : m_writes) iter.setDstSet(set);
+					if (!m_writes.empty()) vk::Device(*device).updateDescriptorSets(m_writes, nullptr);
+					return clear();
+				}
+				decltype(auto) clear() {
+					m_writes.clear();
+					m_buffer_infos.clear();
+					m_image_infos.clear();
+					return *this;
+				}
+			private:
+				std::vector<vk::WriteDescriptorSet> m_writes;
+				std::deque<vk::DescriptorBufferInfo> m_buffer_infos; // deque keeps the addresses stable
+				std::deque<vk::DescriptorImageInfo> m_image_infos;
+			};
+
+			struct bindless_table_ci_t {
+				const device_t* device = nullptr;
+				std::uint32_t image_capacity = 4096;
+				std::uint32_t buffer_capacity = 4096;
+				vk::ShaderStageFlags stage_flags = vk::ShaderStageFlagBits::eAll;
+				decltype(auto) set_device(device_t const* device) { this->device = device; return *this; }
+				decltype(auto) set_image_capacity(std::uint32_t image_capacity) { this->image_capacity = image_capacity; return *this; }
+				decltype(auto) set_buffer_capacity(std::uint32_t buffer_capacity) { this->buffer_capacity = buffer_capacity; return *this; }
+				decltype(auto) set_stage_flags(vk::ShaderStageFlags const& stage_flags) { this->stage_flags = stage_flags; return *this; }
+			};
+			/*
+				one set holding every texture and storage buffer, shaders index it by the slot returned from add_*()
+					layout (set = n, binding = 0) uniform sampler2D images[];
+					layout (set = n, binding = 1) buffer buffers_t { ... } buffers[];
+				slots are written with update after bind, so adding resources never rebuilds a layout or a pipeline
+				needs device_usage_t::set_descriptor_indexing(true), is_valid() is false otherwise
+			*/
+			class bindless_table_t {
+			public:
+				static constexpr std::uint32_t image_binding = 0;
+				static constexpr std::uint32_t buffer_binding = 1;
+
+				bindless_table_t(bindless_table_ci_t const& ci) : m_ci(ci) {
+					assert(m_ci.device);
+					if (!m_ci.device->is_descriptor_indexing()) { std::cerr << "can't build bindless table without descriptor indexing" << std::endl; return; }
+					std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+						vk::DescriptorSetLayoutBinding().setBinding(image_binding).setDescriptorType(vk::DescriptorType::eCombinedImageSampler).setDescriptorCount(m_ci.image_capacity).setStageFlags(m_ci.stage_flags),
+						vk::DescriptorSetLayoutBinding().setBinding(buffer_binding).setDescriptorType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(m_ci.buffer_capacity).setStageFlags(m_ci.stage_flags)
+					};
+					std::vector<vk::DescriptorBindingFlagsEXT> binding_flags(bindings.size(), vk::DescriptorBindingFlagBitsEXT::ePartiallyBound | vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind);
+					auto binding_flags_ci = vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT()
+						.setBindingCount(binding_flags.size())
+						.setPBindingFlags(binding_flags.data());
+					m_layout = vk::Device(*m_ci.device).createDescriptorSetLayout(
+						vk::DescriptorSetLayoutCreateInfo()
+						.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT)
+						.setBindingCount(bindings.size())
+						.setPBindings(bindings.data())
+						.setPNext(&binding_flags_ci)
+					);
+					std::vector<vk::DescriptorPoolSize> pool_sizes = {
+						vk::DescriptorPoolSize().setType(vk::DescriptorType::eCombinedImageSampler).setDescriptorCount(m_ci.image_capacity),
+						vk::DescriptorPoolSize().setType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(m_ci.buffer_capacity)
+					};
+					m_pool = vk::Device(*m_ci.device).createDescriptorPool(
+						vk::DescriptorPoolCreateInfo()
+						.setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT)
+						.setPoolSizeCount(pool_sizes.size())
+						.setPPoolSizes(pool_sizes.data())
+						.setMaxSets(1)
+					);
+					m_set = vk::Device(*m_ci.device).allocateDescriptorSets(
+						vk::DescriptorSetAllocateInfo()
+						.setDescriptorPool(m_pool)
+						.setDescriptorSetCount(1)
+						.setPSetLayouts(&m_layout)
+					)[0];
+				}
+				bindless_table_t(bindless_table_t const&) = delete;
+				bindless_table_t& operator=(bindless_table_t const&) = delete;
+				~bindless_table_t() {
+					if (!m_layout) return;
+					m_ci.device->defer_destroy(m_pool);
+					m_ci.device->defer_destroy(m_layout);
+				}
+
+				decltype(auto) is_valid() const { return static_cast<bool>(m_layout); }
+				decltype(auto) layout() const { return m_layout; }
+				decltype(auto) set() const { return m_set; }
+
+				decltype(auto) add_image(vk::ImageView view, vk::ImageLayout layout, vk::Sampler sampler) {
+					auto slot = m_images.acquire(m_ci.image_capacity);
+					set_image(slot, view, layout, sampler);
+					return slot;
+				}
+				decltype(auto) add_buffer(vk::Buffer buffer, vk::DeviceSize range = VK_WHOLE_SIZE, vk::DeviceSize offset = 0) {
+					auto slot = m_buffers.acquire(m_ci.buffer_capacity);
+					set_buffer(slot, buffer, range, offset);
+					return slot;
+				}
+				// the slot may be rewritten while command buffers using other slots are pending
+				decltype(auto) set_image(std::uint32_t slot, vk::ImageView view, vk::ImageLayout layout, vk::Sampler sampler) {
+					assert(is_valid() && slot < m_ci.image_capacity);
+					descriptor_writer_t().write_image(image_binding, vk::DescriptorType::eCombinedImageSampler, view, layout, sampler, slot).update(m_ci.device, m_set);
+					return *this;
+				}
+				decltype(auto) set_buffer(std::uint32_t slot, vk::Buffer buffer, vk::DeviceSize range = VK_WHOLE_SIZE, vk::DeviceSize offset = 0) {
+					assert(is_valid() && slot < m_ci.buffer_capacity);
+					descriptor_writer_t().write_buffer(buffer_binding, vk::DescriptorType::eStorageBuffer, buffer, range, offset, slot).update(m_ci.device, m_set);
+					return *this;
+				}
+				// the slot is handed out again by the next add_*(), the gpu must be done with it
+				decltype(auto) remove_image(std::uint32_t slot) { m_images.release(slot); return *this; }
+				decltype(auto) remove_buffer(std::uint32_t slot) { m_buffers.release(slot); return *this; }
+				decltype(auto) image_count() const { return m_images.count(); }
+				decltype(auto) buffer_count() const { return m_buffers.count(); }
+			private:
+				struct slots_t {
+					std::uint32_t next = 0;
+					std::vector<std::uint32_t> free;
+					decltype(auto) acquire(std::uint32_t capacity) {
+						std::uint32_t result = next;
+						if (!free.empty()) { result = free.back(); free.pop_back(); }
+						else ++next;
+						if (result >= capacity) std::cerr << "can't add more than " << capacity << " bindless descriptors" << std::endl;
+						assert(result < capacity);
+						return result;
+					}
+					void release(std::uint32_t slot) { assert(slot < next); free.push_back(slot); }
+					decltype(auto) count() const { return static_cast<std::uint32_t>(next - free.size()); }
+				};
+			private:
+				bindless_table_ci_t m_ci;
+				vk::DescriptorSetLayout m_layout;
+				vk::DescriptorPool m_pool;
+				vk::DescriptorSet m_set;
+				slots_t m_images;
+				slots_t m_buffers;
+			};
+		}
+	}
+}
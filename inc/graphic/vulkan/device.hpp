@@ -1,6 +1,12 @@
 #pragma once
 
+#include "./../../config/platform_macro.hpp"
+#ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#ifdef CW_CONFIG_USE_PLATFORM_XCB
+#define VK_USE_PLATFORM_XCB_KHR
+#endif
 #include <vulkan/vulkan.hpp>
 #include <iostream>
 #include <sstream>
@@ -9,8 +15,15 @@
 #include <optional>
 #include <numeric>
 #include <climits>
+#include <limits>
 #include <unordered_map>
 #include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <variant>
 using namespace std::string_literals;
 
 #ifdef max
@@ -237,6 +250,7 @@ namespace cw {
 				std::optional<vk::PhysicalDeviceType> physical_type = std::nullopt;
 				std::optional<vk::PhysicalDeviceFeatures> features = std::nullopt;
 				std::optional<std::vector<const char*>> device_extensions = std::nullopt;
+				bool descriptor_indexing = false; // VK_EXT_descriptor_indexing for bindless_table_t, silently off when unsupported
 				decltype(auto) set_graphic(bool const& graphic, std::uint32_t const& count = 1) { this->graphic = { graphic, count }; return *this; }
 				decltype(auto) set_compute(bool const& compute, std::uint32_t const& count = 1) { this->compute = { compute, count }; return *this; }
 				decltype(auto) set_transfer(bool const& transfer, std::uint32_t const& count = 1) { this->transfer = { transfer, count }; return *this; }
@@ -244,6 +258,7 @@ namespace cw {
 				decltype(auto) set_physical_type(vk::PhysicalDeviceType const& physical_type) { this->physical_type = physical_type; return *this; }
 				decltype(auto) set_features(vk::PhysicalDeviceFeatures const& features) { this->features = features; return *this; }
 				decltype(auto) set_device_extensions(std::vector<const char*> const& device_extensions) { this->device_extensions = device_extensions; return *this; }
+				decltype(auto) set_descriptor_indexing(bool const& descriptor_indexing) { this->descriptor_indexing = descriptor_indexing; return *this; }
 			};
 			struct device_ci_t {
 				std::uint32_t api_version = VK_API_VERSION_1_1;
@@ -253,6 +268,7 @@ namespace cw {
 				device_usage_t usage;
 				std::optional<std::vector<const char*>> instance_layers;
 				std::optional<std::vector<const char*>> instance_extensions;
+				float budget_warning = 0.9f; // warn once a heap's usage would pass this share of its budget
 				decltype(auto) set_api_version(std::uint32_t const& api_version) { this->api_version = api_version; return *this; }
 				decltype(auto) set_debug(bool const& debug) { this->debug = debug; return *this; }
 				decltype(auto) set_monitor(bool const& monitor) { this->monitor = monitor; return *this; }
@@ -260,7 +276,61 @@ namespace cw {
 				decltype(auto) set_usage(device_usage_t const& usage) { this->usage = usage; return *this; }
 				decltype(auto) set_instance_layers(std::vector<const char*> const& instance_layers) { this->instance_layers = instance_layers; return *this; }
 				decltype(auto) set_instance_extensions(std::vector<const char*> const& instance_extensions) { this->instance_extensions = instance_extensions; return *this; }
+				decltype(auto) set_budget_warning(float const& budget_warning) { this->budget_warning = budget_warning; return *this; }
+			};
+			// one memory heap, as reported by device_t::memory_snapshot()
+			struct memory_heap_stat_t {
+				std::uint32_t heap = 0;
+				vk::MemoryHeapFlags flags;
+				vk::DeviceSize size = 0;
+				vk::DeviceSize budget = 0; // VK_EXT_memory_budget when available, otherwise 80% of size
+				vk::DeviceSize usage = 0; // of the whole process as reported by the driver, otherwise allocated
+				vk::DeviceSize allocated = 0; // through device_t::allocate_memory()
+				vk::DeviceSize requested = 0; // what the resources asked for, the rest is lost to alignment and rounding
+				vk::DeviceSize peak = 0;
+				std::uint64_t allocation_count = 0;
+				decltype(auto) fragmentation() const { return allocated == 0 ? 0.0 : 1.0 - static_cast<double>(requested) / static_cast<double>(allocated); }
+			};
+			struct memory_snapshot_t {
+				bool budget_extension = false; // budget and usage come from the driver
+				std::vector<memory_heap_stat_t> heaps;
+				decltype(auto) allocated() const { vk::DeviceSize result = 0; for (const auto& iter : heaps) result += iter.allocated; return result; }
+				decltype(auto) allocation_count() const { std::uint64_t result = 0; for (const auto& iter : heaps) result += iter.allocation_count; return result; }
 			};
+			// what the memory is used for, device_t::find_memory_index() scores every memory type against it
+			enum class memory_intent_e {
+				e_static, // written once (through a staging copy when it isn't host visible), read by the gpu
+				e_upload, // written by the host every frame and read by the gpu, device local + host visible when there is such a type
+				e_readback, // written by the gpu and read by the host
+				e_staging, // source of a transfer, kept out of device local + host visible memory which is often small
+				e_null
+			};
+			namespace func {
+				// an upload takes at most this part of what is left of a device local + host visible heap's budget,
+				// without resizable bar that heap is a 256MB window which the textures and the render targets need as well
+				constexpr double upload_heap_share = 0.25;
+				/*
+					std::nullopt when a type can't serve the intent, higher is better
+					heap_share is the part of what is left of the heap's budget the allocation takes, larger than 1 when it doesn't fit
+				*/
+				inline decltype(auto) score_memory_type(vk::MemoryPropertyFlags flags, memory_intent_e intent, double heap_share = 0.0) {
+					std::optional<int> result = std::nullopt;
+					if (flags & (vk::MemoryPropertyFlagBits::eProtected | vk::MemoryPropertyFlagBits::eLazilyAllocated)) return result;
+					auto device_local = static_cast<bool>(flags & vk::MemoryPropertyFlagBits::eDeviceLocal);
+					auto host_visible = static_cast<bool>(flags & vk::MemoryPropertyFlagBits::eHostVisible);
+					auto host_coherent = static_cast<bool>(flags & vk::MemoryPropertyFlagBits::eHostCoherent);
+					auto host_cached = static_cast<bool>(flags & vk::MemoryPropertyFlagBits::eHostCached);
+					switch (intent) {
+					// uma and software devices only have types which are both, prefer the plainest one
+					case memory_intent_e::e_static: result = (device_local ? 100 : 0) - (host_visible ? 10 : 0) - (host_cached ? 1 : 0); break;
+					// mapped writes are never flushed, coherent first, write combined (uncached) beats cached, device local unless the heap is too small for it
+					case memory_intent_e::e_upload: if (host_visible) result = (host_coherent ? 200 : 0) + (device_local ? (heap_share <= upload_heap_share ? 100 : -100) : 0) - (host_cached ? 1 : 0); break;
+					case memory_intent_e::e_readback: if (host_visible) result = (host_coherent ? 200 : 0) + (host_cached ? 100 : 0) - (device_local ? 1 : 0); break;
+					case memory_intent_e::e_staging: if (host_visible) result = (host_coherent ? 200 : 0) - (device_local ? 100 : 0) - (host_cached ? 1 : 0); break;
+					}
+					return result;
+				}
+			}
 			class device_t {
 			public:
 				struct queue_family_t {
@@ -274,6 +344,13 @@ namespace cw {
 					//decltype(auto) set_count(std::uint32_t const& count) { this->count = count; return *this; }
 				};
 				using single_command_t = std::pair<vk::CommandBuffer, const queue_family_t*>;
+				// objects handed to defer_destroy(), a function covers the rest (e.g. freeing command buffers)
+				using deferred_t = std::variant<
+					vk::Buffer, vk::Image, vk::ImageView, vk::DeviceMemory, vk::Sampler,
+					vk::Pipeline, vk::PipelineLayout, vk::DescriptorSetLayout, vk::DescriptorPool,
+					vk::Framebuffer, vk::RenderPass, vk::SwapchainKHR, vk::Fence, vk::Semaphore, vk::QueryPool, vk::CommandPool,
+					std::function<void()>
+				>;
 
 				//device_t() {}
 				device_t(device_ci_t const& ci) {
@@ -295,6 +372,9 @@ namespace cw {
 							extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
 #ifdef VK_USE_PLATFORM_WIN32_KHR
 							extensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+							extensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
 #endif
 						}
 
@@ -416,6 +496,8 @@ namespace cw {
 						m_support_feature = m_physical_device.getFeatures();
 						if (ci.usage.features.has_value()) m_enable_feature = ci.usage.features.value();
 						m_memory_property = m_physical_device.getMemoryProperties();
+						m_memory.heaps.resize(m_memory_property.memoryHeapCount);
+						m_memory.budget_warning = ci.budget_warning;
 					}
 					// device
 					{
@@ -424,6 +506,29 @@ namespace cw {
 						if (ci.usage.device_extensions.has_value()) extensions.assign(ci.usage.device_extensions.value().begin(), ci.usage.device_extensions.value().end());
 						if (ci.debug) extensions.push_back(VK_EXT_DEBUG_MARKER_EXTENSION_NAME);
 						if (ci.surface) extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+						// only the features bindless_table_t relies on are turned on
+						vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexing_feature;
+						if (ci.usage.descriptor_indexing && std::find(m_device_support_extensions.begin(), m_device_support_extensions.end(), VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) != m_device_support_extensions.end()) {
+							vk::PhysicalDeviceDescriptorIndexingFeaturesEXT support;
+							auto features = vk::PhysicalDeviceFeatures2().setPNext(&support);
+							m_physical_device.getFeatures2(&features);
+							if (support.runtimeDescriptorArray && support.descriptorBindingPartiallyBound && support.shaderSampledImageArrayNonUniformIndexing
+								&& support.descriptorBindingSampledImageUpdateAfterBind && support.descriptorBindingStorageBufferUpdateAfterBind) {
+								indexing_feature
+									.setRuntimeDescriptorArray(VK_TRUE)
+									.setDescriptorBindingPartiallyBound(VK_TRUE)
+									.setShaderSampledImageArrayNonUniformIndexing(VK_TRUE)
+									.setDescriptorBindingSampledImageUpdateAfterBind(VK_TRUE)
+									.setDescriptorBindingStorageBufferUpdateAfterBind(VK_TRUE);
+								extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+								m_descriptor_indexing = true;
+							}
+						}
+						if (ci.usage.descriptor_indexing && !m_descriptor_indexing) std::cerr << "can't enable descriptor indexing, bindless descriptors are disabled" << std::endl;
+						if (std::find(m_device_support_extensions.begin(), m_device_support_extensions.end(), VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) != m_device_support_extensions.end()) {
+							extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+							m_memory.budget_extension = true;
+						}
 
 						std::vector<const char*> enable_extensions;
 						for (const auto& user : extensions) {
@@ -459,6 +564,7 @@ namespace cw {
 							.setQueueCreateInfoCount(queue_cis.size())
 							.setPQueueCreateInfos(queue_cis.data())
 							.setPEnabledFeatures(m_enable_feature.has_value() ? &m_enable_feature.value() : nullptr)
+							.setPNext(m_descriptor_indexing ? &indexing_feature : nullptr)
 						);
 
 						if (m_queue_familys.graphic.has_value()) {
@@ -504,7 +610,7 @@ namespace cw {
 					}
 				}
 				~device_t() {
-					m_device.waitIdle();
+					flush_deferred();
 					if (m_queue_familys.sparse_binding.has_value()) { m_device.destroyCommandPool(m_queue_familys.sparse_binding.value().command_pool); }
 					if (m_queue_familys.transfer.has_value()) { m_device.destroyCommandPool(m_queue_familys.transfer.value().command_pool); }
 					if (m_queue_familys.compute.has_value()) { m_device.destroyCommandPool(m_queue_familys.compute.value().command_pool); }
@@ -544,6 +650,7 @@ namespace cw {
 				decltype(auto) get_physical_device() const { return m_physical_device; }
 				decltype(auto) get_device() const { return m_device; }
 				decltype(auto) get_dispatch() const { return m_dispatch; }
+				decltype(auto) is_descriptor_indexing() const { return m_descriptor_indexing; }
 
 				decltype(auto) begin_single_command(vk::QueueFlagBits const& flag = vk::QueueFlagBits::eGraphics) const {
 					single_command_t result;
@@ -570,7 +677,7 @@ namespace cw {
 					m_device.freeCommandBuffers(single_command.second->command_pool, { single_command.first });
 				}
 
-				decltype(auto) build_shader(std::wstring const& filename) const {
+				decltype(auto) build_shader(std::filesystem::path const& filename) const {
 					std::size_t shader_size;
 					char* shader_code = NULL;
 					std::ifstream is(filename, std::ios::binary | std::ios::in | std::ios::ate);
@@ -592,7 +699,7 @@ namespace cw {
 						return shader_module;
 					}
 					else {
-						std::wcerr << L"Error: Could not open shader file \"" << filename << L"\"" << std::endl;
+						std::cerr << "can't open shader file \"" << filename.string() << "\"" << std::endl;
 						return (vk::ShaderModule)nullptr;
 					}
 				}
@@ -600,11 +707,195 @@ namespace cw {
 					m_device.destroyShaderModule(shader_module);
 				}
 
+				// every type which can serve the intent, best first, ties go to the lower index, byte is weighed against what is left of each heap's budget
+				decltype(auto) rank_memory_types(std::uint32_t type_bits, memory_intent_e intent, vk::DeviceSize byte = 0) const {
+					std::vector<std::pair<int, std::uint32_t>> scores;
+					auto heaps = byte != 0 ? memory_snapshot().heaps : std::vector<memory_heap_stat_t>();
+					for (std::uint32_t i = 0; i < m_memory_property.memoryTypeCount; ++i) {
+						if ((type_bits & (1u << i)) == 0) continue;
+						auto share = 0.0;
+						if (!heaps.empty()) {
+							auto& heap = heaps[m_memory_property.memoryTypes[i].heapIndex];
+							share = heap.usage < heap.budget ? static_cast<double>(byte) / static_cast<double>(heap.budget - heap.usage) : std::numeric_limits<double>::infinity();
+						}
+						auto score = func::score_memory_type(m_memory_property.memoryTypes[i].propertyFlags, intent, share);
+						if (score.has_value()) scores.push_back({ score.value(), i });
+					}
+					std::stable_sort(scores.begin(), scores.end(), [](auto const& a, auto const& b) { return a.first > b.first; });
+					std::vector<std::uint32_t> result;
+					for (const auto& iter : scores) result.push_back(iter.second);
+					return result;
+				}
+				// the best scoring type
+				decltype(auto) find_memory_index(std::uint32_t type_bits, memory_intent_e intent, vk::DeviceSize byte = 0) const {
+					auto types = rank_memory_types(type_bits, intent, byte);
+					if (types.empty()) std::cerr << "can't find memory type for intent " << static_cast<int>(intent) << std::endl;
+					return types.at(0);
+				}
+				decltype(auto) memory_type_flags(std::uint32_t type) const { return m_memory_property.memoryTypes[type].propertyFlags; }
+				decltype(auto) allocate_memory(vk::MemoryRequirements const& requirement, vk::MemoryPropertyFlags flags, std::optional<vk::DeviceSize> requested = std::nullopt) const {
+					return allocate_memory(requirement, find_memory_index(requirement.memoryTypeBits, flags), requested);
+				}
+				decltype(auto) allocate_memory(vk::MemoryRequirements const& requirement, memory_intent_e intent, std::optional<vk::DeviceSize> requested = std::nullopt) const {
+					return allocate_memory_for(requirement, intent, requested).first;
+				}
+				// the memory and its type, when the heap of a type is out of memory the next best type for the intent is tried
+				std::pair<vk::DeviceMemory, std::uint32_t> allocate_memory_for(vk::MemoryRequirements const& requirement, memory_intent_e intent, std::optional<vk::DeviceSize> requested = std::nullopt) const {
+					auto types = rank_memory_types(requirement.memoryTypeBits, intent, requirement.size);
+					if (types.empty()) std::cerr << "can't find memory type for intent " << static_cast<int>(intent) << std::endl;
+					for (std::size_t i = 0; i + 1 < types.size(); ++i) {
+						try { return { allocate_memory(requirement, types[i], requested), types[i] }; }
+						catch (vk::OutOfDeviceMemoryError const&) {
+							std::cerr << "memory type " << types[i] << " is out of device memory, trying memory type " << types[i + 1] << std::endl;
+						}
+					}
+					return { allocate_memory(requirement, types.at(types.size() - 1), requested), types.back() };
+				}
+				// accounted per heap, requested is the byte count the resource needs and defaults to the allocation size
+				vk::DeviceMemory allocate_memory(vk::MemoryRequirements const& requirement, std::uint32_t type, std::optional<vk::DeviceSize> requested = std::nullopt) const {
+					auto heap = m_memory_property.memoryTypes[type].heapIndex;
+					check_budget(heap, requirement.size);
+					auto result = m_device.allocateMemory(
+						vk::MemoryAllocateInfo()
+						.setAllocationSize(requirement.size)
+						.setMemoryTypeIndex(type)
+					);
+					std::unique_lock<std::mutex> lock(m_memory.mutex);
+					auto& stat = m_memory.heaps[heap];
+					auto byte = requested.has_value() ? (std::min)(requested.value(), requirement.size) : requirement.size;
+					stat.allocated += requirement.size;
+					stat.requested += byte;
+					stat.peak = (std::max)(stat.peak, stat.allocated);
+					++stat.allocation_count;
+					m_memory.allocations.insert({ static_cast<VkDeviceMemory>(result), { heap, requirement.size, byte } });
+					return result;
+				}
+				void free_memory(vk::DeviceMemory memory) const {
+					if (!memory) return;
+					{
+						std::unique_lock<std::mutex> lock(m_memory.mutex);
+						auto iter = m_memory.allocations.find(static_cast<VkDeviceMemory>(memory));
+						if (iter != m_memory.allocations.end()) {
+							auto& stat = m_memory.heaps[iter->second.heap];
+							stat.allocated -= iter->second.size;
+							stat.requested -= iter->second.requested;
+							--stat.allocation_count;
+							m_memory.allocations.erase(iter);
+						}
+					}
+					m_device.freeMemory(memory);
+				}
+				decltype(auto) memory_snapshot() const {
+					memory_snapshot_t result;
+					result.budget_extension = m_memory.budget_extension;
+					vk::PhysicalDeviceMemoryBudgetPropertiesEXT budget;
+					if (m_memory.budget_extension) {
+						auto properties = vk::PhysicalDeviceMemoryProperties2().setPNext(&budget);
+						m_physical_device.getMemoryProperties2(&properties);
+					}
+					std::unique_lock<std::mutex> lock(m_memory.mutex);
+					for (std::uint32_t i = 0; i < m_memory_property.memoryHeapCount; ++i) {
+						auto stat = m_memory.heaps[i];
+						stat.heap = i;
+						stat.flags = m_memory_property.memoryHeaps[i].flags;
+						stat.size = m_memory_property.memoryHeaps[i].size;
+						stat.budget = m_memory.budget_extension ? budget.heapBudget[i] : stat.size / 5 * 4;
+						stat.usage = m_memory.budget_extension ? budget.heapUsage[i] : stat.allocated;
+						result.heaps.push_back(stat);
+					}
+					return result;
+				}
+				void log_memory(std::ostream& os) const {
+					auto snapshot = memory_snapshot();
+					auto mib = [](vk::DeviceSize byte) { return static_cast<double>(byte) / (1024.0 * 1024.0); };
+					for (const auto& iter : snapshot.heaps) {
+						os << "heap " << iter.heap << ((iter.flags & vk::MemoryHeapFlagBits::eDeviceLocal) ? " (device local)" : "")
+							<< " : " << mib(iter.allocated) << "MiB in " << iter.allocation_count << " allocations (peak " << mib(iter.peak) << "MiB, "
+							<< static_cast<int>(iter.fragmentation() * 100.0) << "% lost to alignment), usage " << mib(iter.usage) << "MiB of "
+							<< mib(iter.budget) << "MiB budget" << (snapshot.budget_extension ? "" : " (estimated)") << std::endl;
+					}
+				}
+
+				/*
+					deferred destruction :
+						every frame submission takes the current timeline value, objects deferred meanwhile are tagged with it
+						and destroyed once retire_timeline() reports a value at least as large (window_t does both once per frame)
+					work submitted outside of frames has to be waited for before its objects are deferred
+				*/
+				decltype(auto) timeline() const { std::unique_lock<std::mutex> lock(m_deferred.mutex); return m_deferred.current; }
+				// the value of the work submitted now
+				decltype(auto) advance_timeline() const { std::unique_lock<std::mutex> lock(m_deferred.mutex); return m_deferred.current++; }
+				// every submission up to value has completed
+				void retire_timeline(std::uint64_t value) const {
+					{
+						std::unique_lock<std::mutex> lock(m_deferred.mutex);
+						if (value > m_deferred.completed) m_deferred.completed = value;
+					}
+					collect_deferred();
+				}
+				void defer_destroy(deferred_t object) const {
+					std::unique_lock<std::mutex> lock(m_deferred.mutex);
+					m_deferred.queue.push_back({ m_deferred.current, std::move(object) });
+				}
+				decltype(auto) deferred_count() const { std::unique_lock<std::mutex> lock(m_deferred.mutex); return m_deferred.queue.size(); }
+				// waits for the device, then destroys everything deferred so far
+				void flush_deferred() const {
+					m_device.waitIdle();
+					retire_timeline(timeline());
+				}
+
 				operator vk::Instance() const { return m_instance; }
 				operator vk::PhysicalDevice() const { return m_physical_device; }
 				operator vk::Device() const { return m_device; }
 				operator vk::DispatchLoaderDynamic() const { return m_dispatch; }
 			private:
+				void collect_deferred() const {
+					std::vector<deferred_t> objects;
+					{
+						std::unique_lock<std::mutex> lock(m_deferred.mutex);
+						while (!m_deferred.queue.empty() && m_deferred.queue.front().first <= m_deferred.completed) {
+							objects.push_back(std::move(m_deferred.queue.front().second));
+							m_deferred.queue.pop_front();
+						}
+					}
+					// in the order they were deferred, views before images before memory
+					for (auto& iter : objects) std::visit([this](auto& object) { destroy_deferred(object); }, iter);
+				}
+				void destroy_deferred(vk::DeviceMemory memory) const { free_memory(memory); }
+				// warns once per heap until its usage falls back below the threshold
+				// the driver is queried once per frame (timeline value) or every budget_refresh allocations, in between the usage
+				// is estimated from the cached query plus what was allocated since, and confirmed by a query once it nears the threshold
+				void check_budget(std::uint32_t heap, vk::DeviceSize byte) const {
+					auto is_over = [this, byte](memory_heap_stat_t const& stat) { return static_cast<double>(stat.usage + byte) > static_cast<double>(stat.budget) * m_memory.budget_warning; };
+					auto frame = timeline();
+					memory_heap_stat_t stat;
+					bool refresh = true;
+					{
+						std::unique_lock<std::mutex> lock(m_memory.mutex);
+						if (!m_memory.budget_cache.empty() && m_memory.budget_frame == frame && ++m_memory.budget_age < m_memory.budget_refresh) {
+							stat = m_memory.budget_cache[heap];
+							stat.usage = (std::max)(stat.usage + m_memory.heaps[heap].allocated, stat.allocated) - stat.allocated;
+							refresh = m_memory.budget_extension && is_over(stat);
+						}
+					}
+					if (refresh) {
+						auto snapshot = memory_snapshot();
+						stat = snapshot.heaps[heap];
+						std::unique_lock<std::mutex> lock(m_memory.mutex);
+						m_memory.budget_cache = std::move(snapshot.heaps);
+						m_memory.budget_frame = frame;
+						m_memory.budget_age = 0;
+					}
+					std::unique_lock<std::mutex> lock(m_memory.mutex);
+					auto over = is_over(stat);
+					if (over && !m_memory.warned[heap]) {
+						std::cerr << "memory heap " << heap << " is close to its budget : " << (stat.usage + byte) / (1024 * 1024) << "MiB of " << stat.budget / (1024 * 1024) << "MiB" << std::endl;
+					}
+					m_memory.warned[heap] = over;
+				}
+				void destroy_deferred(std::function<void()> const& func) const { if (func) func(); }
+				template<typename _type>
+				void destroy_deferred(_type object) const { m_device.destroy(object); }
 				static VKAPI_ATTR VkBool32 VKAPI_CALL debug_utils_messenger_callback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
 					std::string prefix("");
 					if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) prefix = "[ VERBOSE ]";
@@ -641,6 +932,30 @@ namespace cw {
 				vk::Device m_device;
 				std::vector<std::string> m_device_support_extensions;
 				std::optional<std::vector<std::string>> m_device_enable_extensions;
+				bool m_descriptor_indexing = false;
+				mutable struct {
+					std::mutex mutex;
+					bool budget_extension = false;
+					float budget_warning = 0.9f;
+					std::vector<memory_heap_stat_t> heaps;
+					std::bitset<VK_MAX_MEMORY_HEAPS> warned;
+					std::vector<memory_heap_stat_t> budget_cache; // the last driver query, see check_budget()
+					std::uint64_t budget_frame = 0;
+					std::uint32_t budget_age = 0;
+					std::uint32_t budget_refresh = 64;
+					struct allocation_t {
+						std::uint32_t heap;
+						vk::DeviceSize size;
+						vk::DeviceSize requested;
+					};
+					std::unordered_map<VkDeviceMemory, allocation_t> allocations;
+				}m_memory;
+				mutable struct {
+					std::mutex mutex;
+					std::uint64_t current = 1;
+					std::uint64_t completed = 0;
+					std::deque<std::pair<std::uint64_t, deferred_t>> queue; // tags never decrease
+				}m_deferred;
 			};
 		}
 	}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "./device.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace cw {
+	namespace graphic {
+		namespace vulkan {
+			// rolling gpu time of one pass, in milliseconds
+			struct gpu_pass_timing_t {
+				std::string name;
+				double last = 0.0;
+				double p50 = 0.0;
+				double p95 = 0.0;
+				double p99 = 0.0;
+				std::uint64_t sample_count = 0;
+			};
+			/*
+				timestamp queries, one pool per recorded command buffer so results are read back without waiting :
+					query 0 / 1					begin / end of the whole pass
+					query 2 + 2 * i / 3 + 2 * i	begin / end of sub pass i
+			*/
+			class gpu_profiler_t {
+			public:
+				gpu_profiler_t(const device_t* device, std::uint32_t history = 256) : m_device(device), m_history(history) {
+					assert(m_device && m_history > 0);
+					m_period = vk::PhysicalDevice(*m_device).getProperties().limits.timestampPeriod;
+					auto family = m_device->get_queue_familys().graphic.value().index;
+					m_valid_bits = vk::PhysicalDevice(*m_device).getQueueFamilyProperties()[family].timestampValidBits;
+					if (m_valid_bits == 0) std::cerr << "graphic queue doesn't support timestamps, gpu profiler is disabled" << std::endl;
+				}
+				gpu_profiler_t(gpu_profiler_t const&) = delete;
+				gpu_profiler_t& operator=(gpu_profiler_t const&) = delete;
+				~gpu_profiler_t() { clean(); }
+
+				decltype(auto) is_supported() const { return m_valid_bits != 0; }
+				// called whenever the command buffers are recorded again, keeps the history when the layout is unchanged
+				void resize(std::uint32_t pool_count, std::uint32_t pass_count) {
+					if (!is_supported()) return;
+					if (pass_count != m_pass_count || m_samples.empty()) {
+						m_samples.assign(pass_count + 1, {});
+						m_cursors.assign(pass_count + 1, 0);
+						m_counts.assign(pass_count + 1, 0);
+					}
+					if (pool_count == m_pools.size() && pass_count == m_pass_count) { for (auto& iter : m_submitted) iter = false; return; }
+					clean();
+					m_pass_count = pass_count;
+					for (std::uint32_t i = 0; i < pool_count; ++i) {
+						m_pools.push_back(vk::Device(*m_device).createQueryPool(
+							vk::QueryPoolCreateInfo()
+							.setQueryType(vk::QueryType::eTimestamp)
+							.setQueryCount(query_count())
+						));
+					}
+					m_submitted.assign(pool_count, false);
+				}
+				// record outside of the render pass
+				void begin(vk::CommandBuffer cmd, std::uint32_t pool) const {
+					if (!is_supported()) return;
+					cmd.resetQueryPool(m_pools[pool], 0, query_count());
+					cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_pools[pool], 0);
+				}
+				void end(vk::CommandBuffer cmd, std::uint32_t pool) const {
+					if (!is_supported()) return;
+					cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_pools[pool], 1);
+				}
+				void begin_pass(vk::CommandBuffer cmd, std::uint32_t pool, std::uint32_t pass) const {
+					if (!is_supported()) return;
+					cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_pools[pool], 2 + 2 * pass);
+				}
+				void end_pass(vk::CommandBuffer cmd, std::uint32_t pool, std::uint32_t pass) const {
+					if (!is_supported()) return;
+					cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_pools[pool], 3 + 2 * pass);
+				}
+				// read back the previous submission of pool if it has completed, never waits
+				void collect(std::uint32_t pool) {
+					if (!is_supported() || !m_submitted[pool]) return;
+					auto& values = m_values;
+					values.resize(query_count());
+					auto result = vk::Device(*m_device).getQueryPoolResults(
+						m_pools[pool], 0, query_count(),
+						values.size() * sizeof(std::uint64_t), values.data(), sizeof(std::uint64_t),
+						vk::QueryResultFlagBits::e64
+					);
+					if (result != vk::Result::eSuccess) return;
+					m_submitted[pool] = false;
+					auto mask = m_valid_bits >= 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << m_valid_bits) - 1);
+					for (std::uint32_t i = 0; i <= m_pass_count; ++i) {
+						auto ticks = ((values[2 * i + 1] & mask) - (values[2 * i] & mask)) & mask;
+						push(i, static_cast<double>(ticks) * m_period / 1000000.0);
+					}
+				}
+				void submitted(std::uint32_t pool) { if (is_supported()) m_submitted[pool] = true; }
+				// index 0 is the whole pass, index 1 + i is sub pass i
+				decltype(auto) timings() const {
+					std::vector<gpu_pass_timing_t> result;
+					if (!is_supported()) return result;
+					for (std::uint32_t i = 0; i <= m_pass_count; ++i) {
+						gpu_pass_timing_t timing;
+						timing.name = i == 0 ? std::string("render pass") : "render_func[" + std::to_string(i - 1) + "]";
+						timing.sample_count = m_counts[i];
+						auto count = static_cast<std::size_t>(std::min<std::uint64_t>(m_counts[i], m_history));
+						if (count != 0) {
+							timing.last = m_samples[i][(m_cursors[i] + m_history - 1) % m_history];
+							std::vector<double> sorted(m_samples[i].begin(), m_samples[i].begin() + count);
+							std::sort(sorted.begin(), sorted.end());
+							auto percentile = [&sorted](double p) { return sorted[static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5)]; };
+							timing.p50 = percentile(0.50);
+							timing.p95 = percentile(0.95);
+							timing.p99 = percentile(0.99);
+						}
+						result.push_back(timing);
+					}
+					return result;
+				}
+				void log(std::ostream& os) const {
+					for (const auto& iter : timings()) {
+						os << iter.name << " : last " << iter.last << "ms, p50 " << iter.p50 << "ms, p95 " << iter.p95 << "ms, p99 " << iter.p99 << "ms (" << iter.sample_count << " samples)" << std::endl;
+					}
+				}
+			private:
+				decltype(auto) query_count() const { return 2 + 2 * m_pass_count; }
+				void push(std::uint32_t pass, double value) {
+					if (m_samples[pass].size() < m_history) m_samples[pass].resize(m_history);
+					m_samples[pass][m_cursors[pass]] = value;
+					m_cursors[pass] = (m_cursors[pass] + 1) % m_history;
+					++m_counts[pass];
+				}
+				void clean() {
+					for (const auto& iter : m_pools) vk::Device(*m_device).destroyQueryPool(iter);
+					m_pools.clear();
+					m_submitted.clear();
+				}
+			private:
+				const device_t* m_device = nullptr;
+				std::uint32_t m_history = 256;
+				float m_period = 1.0f; // nanoseconds per tick
+				std::uint32_t m_valid_bits = 0;
+				std::uint32_t m_pass_count = 0;
+				std::vector<vk::QueryPool> m_pools;
+				std::vector<bool> m_submitted;
+				std::vector<std::vector<double>> m_samples; // ring of m_history per pass
+				std::vector<std::uint32_t> m_cursors;
+				std::vector<std::uint64_t> m_counts;
+				std::vector<std::uint64_t> m_values; // read back by collect(), kept so a frame doesn't allocate
+			};
+		}
+	}
+}
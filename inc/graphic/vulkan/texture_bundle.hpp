@@ -0,0 +1,198 @@
+#pragma once
+
+#include "./device.hpp"
+#include "./../../core/memory.hpp"
+#include "./../../core/mapped_file.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+/*
+	texture bundle file layout (little endian) :
+		texture_bundle_header_t
+		std::uint64_t layer_offsets[layer_count]	// from the beginning of the file
+		layer data, each layer aligned to texture_bundle_header_t::alignment_s
+	layer data is already in the image format, so it can be copied into a staging buffer as is
+*/
+
+namespace cw {
+	namespace graphic {
+		namespace vulkan {
+			struct texture_bundle_header_t {
+				static constexpr std::uint32_t magic_s = 0x42545743; // "CWTB"
+				static constexpr std::uint32_t version_s = 1;
+				static constexpr std::uint64_t alignment_s = 16;
+				std::uint32_t magic = magic_s;
+				std::uint32_t version = version_s;
+				std::uint32_t format = static_cast<std::uint32_t>(vk::Format::eR8G8B8A8Unorm);
+				std::uint32_t width = 0;
+				std::uint32_t height = 0;
+				std::uint32_t layer_count = 0;
+				std::uint64_t layer_byte = 0;
+			};
+			namespace func {
+				inline decltype(auto) align_up(std::uint64_t value, std::uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+				inline decltype(auto) get_texture_layer_byte(vk::Format format, std::uint32_t width, std::uint32_t height) {
+					if (format == vk::Format::eBc3UnormBlock) return static_cast<std::uint64_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+					assert(format == vk::Format::eR8G8B8A8Unorm);
+					return static_cast<std::uint64_t>(width) * height * 4;
+				}
+				// BC3 : 4x4 blocks, 8 byte alpha (BC4 style) followed by 8 byte color (always 4 color mode)
+				inline decltype(auto) compress_bc3_block(std::uint8_t const (&block)[16][4], std::uint8_t* out) {
+					// alpha
+					std::uint8_t alpha_max = 0, alpha_min = 255;
+					for (const auto& iter : block) { if (iter[3] > alpha_max) alpha_max = iter[3]; if (iter[3] < alpha_min) alpha_min = iter[3]; }
+					std::uint32_t alphas[8] = { alpha_max, alpha_min };
+					for (std::uint32_t i = 1; i < 7; ++i) alphas[i + 1] = ((7 - i) * alpha_max + i * alpha_min) / 7;
+					std::uint64_t alpha_bits = 0;
+					for (std::uint32_t i = 0; i < 16; ++i) {
+						std::uint64_t best = 0;
+						std::uint32_t best_error = UINT_MAX;
+						for (std::uint32_t j = 0; j < 8; ++j) {
+							auto error = static_cast<std::uint32_t>(std::abs(static_cast<int>(block[i][3]) - static_cast<int>(alphas[j])));
+							if (error < best_error) { best_error = error; best = j; }
+						}
+						alpha_bits |= best << (3 * i);
+					}
+					out[0] = alpha_max;
+					out[1] = alpha_min;
+					for (std::uint32_t i = 0; i < 6; ++i) out[2 + i] = static_cast<std::uint8_t>(alpha_bits >> (8 * i));
+					// color, endpoints are the corners of the bounding box
+					std::uint8_t color_max[3] = { 0, 0, 0 }, color_min[3] = { 255, 255, 255 };
+					for (const auto& iter : block) {
+						for (std::uint32_t c = 0; c < 3; ++c) { if (iter[c] > color_max[c]) color_max[c] = iter[c]; if (iter[c] < color_min[c]) color_min[c] = iter[c]; }
+					}
+					auto to_565 = [](std::uint8_t const (&rgb)[3]) { return static_cast<std::uint16_t>(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3)); };
+					auto from_565 = [](std::uint16_t color, int (&rgb)[3]) {
+						rgb[0] = ((color >> 11) & 0x1f) * 255 / 31;
+						rgb[1] = ((color >> 5) & 0x3f) * 255 / 63;
+						rgb[2] = (color & 0x1f) * 255 / 31;
+					};
+					auto color0 = to_565(color_max), color1 = to_565(color_min);
+					int colors[4][3];
+					from_565(color0, colors[0]);
+					from_565(color1, colors[1]);
+					for (std::uint32_t c = 0; c < 3; ++c) {
+						colors[2][c] = (2 * colors[0][c] + colors[1][c]) / 3;
+						colors[3][c] = (colors[0][c] + 2 * colors[1][c]) / 3;
+					}
+					std::uint32_t color_bits = 0;
+					for (std::uint32_t i = 0; i < 16; ++i) {
+						std::uint32_t best = 0;
+						int best_error = INT_MAX;
+						for (std::uint32_t j = 0; j < 4; ++j) {
+							int error = 0;
+							for (std::uint32_t c = 0; c < 3; ++c) { auto diff = static_cast<int>(block[i][c]) - colors[j][c]; error += diff * diff; }
+							if (error < best_error) { best_error = error; best = j; }
+						}
+						color_bits |= best << (2 * i);
+					}
+					out[8] = static_cast<std::uint8_t>(color0);
+					out[9] = static_cast<std::uint8_t>(color0 >> 8);
+					out[10] = static_cast<std::uint8_t>(color1);
+					out[11] = static_cast<std::uint8_t>(color1 >> 8);
+					for (std::uint32_t i = 0; i < 4; ++i) out[12 + i] = static_cast<std::uint8_t>(color_bits >> (8 * i));
+				}
+				inline decltype(auto) compress_bc3(std::uint32_t width, std::uint32_t height, core::memory_view_t const& rgba) {
+					assert(rgba.byte() == static_cast<core::ull_t>(width) * height * 4);
+					std::vector<std::uint8_t> result(get_texture_layer_byte(vk::Format::eBc3UnormBlock, width, height));
+					auto pixels = static_cast<const std::uint8_t*>(rgba.data());
+					auto out = result.data();
+					for (std::uint32_t by = 0; by < height; by += 4) {
+						for (std::uint32_t bx = 0; bx < width; bx += 4) {
+							std::uint8_t block[16][4];
+							// clamp at the border for sizes which are not a multiple of 4
+							for (std::uint32_t y = 0; y < 4; ++y) {
+								for (std::uint32_t x = 0; x < 4; ++x) {
+									auto px = (std::min)(bx + x, width - 1), py = (std::min)(by + y, height - 1);
+									memcpy(block[y * 4 + x], pixels + (static_cast<std::size_t>(py) * width + px) * 4, 4);
+								}
+							}
+							compress_bc3_block(block, out);
+							out += 16;
+						}
+					}
+					return result;
+				}
+				// layers are RGBA8 of width * height, they are compressed first when format is BC3
+				inline decltype(auto) pack_texture_bundle(std::string const& path, vk::Format format, std::uint32_t width, std::uint32_t height, std::vector<core::memory_view_t> const& layers) {
+					assert(format == vk::Format::eR8G8B8A8Unorm || format == vk::Format::eBc3UnormBlock);
+					texture_bundle_header_t header;
+					header.format = static_cast<std::uint32_t>(format);
+					header.width = width;
+					header.height = height;
+					header.layer_count = static_cast<std::uint32_t>(layers.size());
+					header.layer_byte = get_texture_layer_byte(format, width, height);
+
+					std::vector<std::uint64_t> offsets(layers.size());
+					auto offset = align_up(sizeof(texture_bundle_header_t) + sizeof(std::uint64_t) * offsets.size(), texture_bundle_header_t::alignment_s);
+					for (auto& iter : offsets) { iter = offset; offset = align_up(offset + header.layer_byte, texture_bundle_header_t::alignment_s); }
+
+					std::ofstream os(path, std::ios::binary | std::ios::out | std::ios::trunc);
+					if (!os.is_open()) { std::cerr << "can't open texture bundle \"" << path << "\"" << std::endl; return false; }
+					os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+					os.write(reinterpret_cast<const char*>(offsets.data()), sizeof(std::uint64_t) * offsets.size());
+					const char zero[texture_bundle_header_t::alignment_s] = {};
+					for (std::size_t i = 0; i < layers.size(); ++i) {
+						auto position = static_cast<std::uint64_t>(os.tellp());
+						os.write(zero, offsets[i] - position);
+						if (format == vk::Format::eBc3UnormBlock) {
+							auto compressed = compress_bc3(width, height, layers[i]);
+							os.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+						}
+						else {
+							assert(layers[i].byte() == header.layer_byte);
+							os.write(static_cast<const char*>(layers[i].data()), header.layer_byte);
+						}
+					}
+					return os.good();
+				}
+			}
+			class texture_bundle_t {
+			public:
+				texture_bundle_t(std::string const& path) : m_file(path) {
+					if (!m_file.is_open()) return;
+					if (m_file.byte() < sizeof(texture_bundle_header_t)) { std::cerr << "invalid texture bundle \"" << path << "\"" << std::endl; return; }
+					m_header = static_cast<const texture_bundle_header_t*>(m_file.data());
+					if (m_header->magic != texture_bundle_header_t::magic_s || m_header->version != texture_bundle_header_t::version_s || m_header->layer_count == 0) {
+						std::cerr << "invalid texture bundle \"" << path << "\"" << std::endl;
+						m_header = nullptr;
+						return;
+					}
+					if (m_file.byte() < sizeof(texture_bundle_header_t) + sizeof(std::uint64_t) * m_header->layer_count) { std::cerr << "truncated texture bundle \"" << path << "\"" << std::endl; m_header = nullptr; return; }
+					m_offsets = reinterpret_cast<const std::uint64_t*>(m_header + 1);
+					// the layers follow the offset table in order without overlapping, and each one lies inside the file
+					auto format = static_cast<vk::Format>(m_header->format);
+					if ((format != vk::Format::eR8G8B8A8Unorm && format != vk::Format::eBc3UnormBlock) || m_header->layer_byte != func::get_texture_layer_byte(format, m_header->width, m_header->height)) {
+						std::cerr << "invalid texture bundle \"" << path << "\"" << std::endl;
+						m_header = nullptr;
+						return;
+					}
+					std::uint64_t end = sizeof(texture_bundle_header_t) + sizeof(std::uint64_t) * m_header->layer_count;
+					for (std::uint32_t i = 0; i < m_header->layer_count; ++i) {
+						if (m_offsets[i] < end || m_offsets[i] > m_file.byte() || m_header->layer_byte > m_file.byte() - m_offsets[i]) {
+							std::cerr << "invalid layer " << i << " in texture bundle \"" << path << "\"" << std::endl;
+							m_header = nullptr;
+							return;
+						}
+						end = m_offsets[i] + m_header->layer_byte;
+					}
+				}
+				decltype(auto) is_valid() const { return m_header != nullptr; }
+				decltype(auto) format() const { return static_cast<vk::Format>(m_header->format); }
+				decltype(auto) width() const { return m_header->width; }
+				decltype(auto) height() const { return m_header->height; }
+				decltype(auto) layer_count() const { return m_header->layer_count; }
+				decltype(auto) layer_byte() const { return m_header->layer_byte; }
+				// offset of the layer inside data()
+				decltype(auto) layer_offset(std::uint32_t layer) const { assert(layer < layer_count()); return m_offsets[layer] - m_offsets[0]; }
+				decltype(auto) layer(std::uint32_t layer) const { assert(layer < layer_count()); return m_file.view(m_offsets[layer], m_header->layer_byte); }
+				// every layer in one contiguous view, ready for a single staging copy
+				decltype(auto) data() const { return m_file.view(m_offsets[0], m_offsets[layer_count() - 1] + m_header->layer_byte - m_offsets[0]); }
+			private:
+				core::mapped_file_t m_file;
+				const texture_bundle_header_t* m_header = nullptr;
+				const std::uint64_t* m_offsets = nullptr;
+			};
+		}
+	}
+}
@@ -3,6 +3,10 @@
 #include "./device.hpp"
 #include "./window.hpp"
 #include "./buffer.hpp"
+#include "./texture_bundle.hpp"
+#include "./capture.hpp"
+#include "./gpu_profiler.hpp"
+#include "./descriptor.hpp"
 
 namespace cw {
 	namespace graphic {
@@ -1,61 +1,113 @@
 #pragma once
 
 #include "./device.hpp"
+#include "./buffer.hpp"
+#include "./capture.hpp"
+#include "./gpu_profiler.hpp"
+#include "./../../core/trace.hpp"
+#include "./../../core/thread_pool.hpp"
+#include "./../../core/inplace_function.hpp"
 #include <functional>
+#include <deque>
+#include <limits>
+#include <chrono>
+#include <algorithm>
 
 namespace cw {
 	namespace graphic {
 		namespace vulkan {
-			using render_func_t = std::function<void(vk::CommandBuffer, vk::Rect2D)>;
+			// stored inline, so keeping and recording them never touches the heap, captures are limited to 64 bytes
+			// the last argument is the frame slot the commands are recorded for, it indexes the per frame resources of the caller
+			using render_func_t = core::inplace_function_t<void(vk::CommandBuffer, vk::Rect2D, std::uint32_t), 64>;
+			// names a render func of a window_t, stays valid while others are added or removed, 0 is never handed out
+			using render_handle_t = std::uint32_t;
+			// what the present mode and the swapchain image count are chosen for
+			enum class present_policy_e {
+				e_lowest_latency, e_lowest_power, e_tear_free, e_null
+			};
+			// input to present latency of one present mode, in milliseconds
+			struct present_latency_t {
+				vk::PresentModeKHR mode = vk::PresentModeKHR::eFifo;
+				double last = 0.0;
+				double average = 0.0;
+				double max = 0.0;
+				std::uint64_t sample_count = 0;
+			};
+			namespace func {
+				// most wanted first, fifo is always supported so every ranking ends with it
+				inline decltype(auto) get_present_mode_ranking(present_policy_e policy) {
+					switch (policy) {
+					case present_policy_e::e_lowest_latency: return std::vector<vk::PresentModeKHR>{ vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eFifoRelaxed, vk::PresentModeKHR::eFifo };
+					case present_policy_e::e_lowest_power: return std::vector<vk::PresentModeKHR>{ vk::PresentModeKHR::eFifo, vk::PresentModeKHR::eFifoRelaxed, vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate };
+					}
+					// fifo relaxed and immediate tear, tear free never falls back to them
+					return std::vector<vk::PresentModeKHR>{ vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eFifo };
+				}
+				inline decltype(auto) choose_present_mode(std::vector<vk::PresentModeKHR> const& supports, present_policy_e policy) {
+					for (const auto& need : get_present_mode_ranking(policy))
+						for (const auto& support : supports)
+							if (need == support) return need;
+					return vk::PresentModeKHR::eFifo;
+				}
+				// mailbox needs a spare image to replace, tear free fifo gets one more to absorb a late frame
+				inline decltype(auto) choose_present_image_count(vk::SurfaceCapabilitiesKHR const& capability, vk::PresentModeKHR mode, present_policy_e policy) {
+					auto result = capability.minImageCount;
+					if (mode == vk::PresentModeKHR::eMailbox) result = (std::max)(capability.minImageCount + 1, 3u);
+					else if (mode != vk::PresentModeKHR::eImmediate && policy == present_policy_e::e_tear_free) result = capability.minImageCount + 1;
+					if (capability.maxImageCount != 0 && result > capability.maxImageCount) result = capability.maxImageCount;
+					return result;
+				}
+			}
+			// render into owned images instead of a swapchain, no surface is needed
+			struct window_offscreen_t {
+				vk::Extent2D extent;
+				vk::Format format = vk::Format::eR8G8B8A8Unorm;
+				std::uint32_t image_count = 2;
+				decltype(auto) set_extent(vk::Extent2D const& extent) { this->extent = extent; return *this; }
+				decltype(auto) set_format(vk::Format const& format) { this->format = format; return *this; }
+				decltype(auto) set_image_count(std::uint32_t const& image_count) { this->image_count = image_count; return *this; }
+			};
 			struct window_ci_t {
 				const device_t* device = nullptr;
 				bool vsync = true;
 				bool depth_stencil = true;
+				std::optional<window_offscreen_t> offscreen;
+				std::optional<present_policy_e> present_policy; // by default vsync picks e_tear_free, otherwise e_lowest_latency
+				std::uint32_t frame_count = 2; // frames in flight of a surface window, an offscreen window has one per image
+				bool profile = false;
+				core::thread_pool_t* thread_pool = nullptr; // render_func_t are recorded on its workers, they must be callable concurrently
 				decltype(auto) set_device(device_t const* device) { this->device = device; return *this; }
 				decltype(auto) set_vsync(bool const& vsync) { this->vsync = vsync; return *this; }
 				decltype(auto) set_depth_stencil(bool const& depth_stencil) { this->depth_stencil = depth_stencil; return *this; }
+				decltype(auto) set_offscreen(window_offscreen_t const& offscreen) { this->offscreen = offscreen; return *this; }
+				decltype(auto) set_present_policy(present_policy_e const& present_policy) { this->present_policy = present_policy; return *this; }
+				decltype(auto) set_frame_count(std::uint32_t const& frame_count) { this->frame_count = frame_count; return *this; }
+				decltype(auto) set_profile(bool const& profile) { this->profile = profile; return *this; }
+				decltype(auto) set_thread_pool(core::thread_pool_t* thread_pool) { this->thread_pool = thread_pool; return *this; }
 #ifdef VK_USE_PLATFORM_WIN32_KHR
 				HINSTANCE hinstance;
 				HWND hwnd;
 				decltype(auto) set_hinstance(HINSTANCE const& hinstance) { this->hinstance = hinstance; return *this; }
 				decltype(auto) set_hwnd(HWND const& hwnd) { this->hwnd = hwnd; return *this; }
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+				xcb_connection_t* xcb_connection = nullptr;
+				xcb_window_t xcb_window = 0;
+				decltype(auto) set_xcb_connection(xcb_connection_t* xcb_connection) { this->xcb_connection = xcb_connection; return *this; }
+				decltype(auto) set_xcb_window(xcb_window_t const& xcb_window) { this->xcb_window = xcb_window; return *this; }
 #endif
 			};
 			class window_t {
 			public:
-				window_t(window_ci_t const& ci) : m_device(ci.device), m_vsync(ci.vsync){
-#ifdef VK_USE_PLATFORM_WIN32_KHR
-					m_surface = vk::Instance(*m_device).createWin32SurfaceKHR(
-						vk::Win32SurfaceCreateInfoKHR()
-						.setHinstance(ci.hinstance)
-						.setHwnd(ci.hwnd)
-					);
-#endif
-					m_support_present_modes = func::find_surface_present_modes(*m_device, m_surface).value();
-					m_support_presents = func::get_surface_supports(*m_device, m_surface);
-
-					const auto& familys = m_device->get_queue_familys();
-					if (familys.graphic.has_value() && m_support_presents[familys.graphic.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.graphic.value().index, 0);
-					else if (familys.transfer.has_value() && m_support_presents[familys.transfer.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.transfer.value().index, 0);
-					else if (familys.compute.has_value() && m_support_presents[familys.compute.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.compute.value().index, 0);
-					else if (familys.sparse_binding.has_value() && m_support_presents[familys.sparse_binding.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.sparse_binding.value().index, 0);
-					else assert(0);
-					assert(m_present_queue != VK_NULL_HANDLE);
+				window_t(window_ci_t const& ci) : m_device(ci.device), m_vsync(ci.vsync), m_present_policy(ci.present_policy), m_offscreen(ci.offscreen) {
+					if (m_offscreen.has_value()) build_offscreen_target();
+					else build_surface_target(ci);
 
-					if (familys.graphic.has_value() && m_support_presents[familys.graphic.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.graphic.value().index, 0);
-					else if (familys.transfer.has_value() && m_support_presents[familys.transfer.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.transfer.value().index, 0);
-					else if (familys.compute.has_value() && m_support_presents[familys.compute.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.compute.value().index, 0);
-					else if (familys.sparse_binding.has_value() && m_support_presents[familys.sparse_binding.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.sparse_binding.value().index, 0);
-					else assert(0);
-					assert(m_submit_queue != VK_NULL_HANDLE);
-
-
-					m_color.surface_format = func::find_surface_formats(*m_device, m_surface).value()[0];
 					if (ci.depth_stencil) m_depth_stencil = depth_stencil_t();
 					if (m_depth_stencil.has_value()) m_depth_stencil.value().format = func::find_depth_stencil_formats(*m_device).value()[0];
 
 					std::vector<vk::AttachmentDescription> attachments;
-					// Color attachment
+					// Color attachment, offscreen images are left ready to be copied out
 					attachments.push_back(
 						vk::AttachmentDescription()
 						.setFormat(m_color.surface_format.format)
@@ -63,7 +115,7 @@ namespace cw {
 						.setLoadOp(vk::AttachmentLoadOp::eClear)
 						.setStoreOp(vk::AttachmentStoreOp::eStore)
 						.setInitialLayout(vk::ImageLayout::eUndefined)
-						.setFinalLayout(vk::ImageLayout::ePresentSrcKHR)
+						.setFinalLayout(m_offscreen.has_value() ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR)
 					);
 					// Depth attachment
 					if (m_depth_stencil.has_value()) {
@@ -122,6 +174,11 @@ namespace cw {
 						.setDstAccessMask(vk::AccessFlagBits::eMemoryRead)
 						.setDependencyFlags(vk::DependencyFlagBits::eByRegion)
 					};
+					if (m_offscreen.has_value()) {
+						dependencies[1]
+							.setDstStageMask(vk::PipelineStageFlagBits::eTransfer)
+							.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+					}
 
 					m_render_pass = vk::Device(*m_device).createRenderPass(
 						vk::RenderPassCreateInfo()
@@ -133,47 +190,102 @@ namespace cw {
 						.setPDependencies(dependencies.data())
 					);
 
-					m_sync.present_available = vk::Device(*m_device).createSemaphore(vk::SemaphoreCreateInfo());
-					m_sync.render_finish = vk::Device(*m_device).createSemaphore(vk::SemaphoreCreateInfo());
+					// the fences outlive the swapchain, a frame slot is reused once the fence of its last submission has signaled
+					auto slot_count = m_offscreen.has_value() ? m_offscreen.value().image_count : ci.frame_count;
+					assert(slot_count > 0);
+					for (std::uint32_t i = 0; i < slot_count; ++i) {
+						m_sync.fences.push_back(vk::Device(*m_device).createFence(vk::FenceCreateInfo().setFlags(vk::FenceCreateFlagBits::eSignaled)));
+						if (!m_offscreen.has_value()) m_sync.present_available.push_back(vk::Device(*m_device).createSemaphore(vk::SemaphoreCreateInfo()));
+					}
+					m_sync.values.assign(slot_count, 0);
 					m_submit_info = vk::SubmitInfo()
-						.setWaitSemaphoreCount(1)
-						.setPWaitSemaphores(&m_sync.present_available)
-						.setSignalSemaphoreCount(1)
-						.setPSignalSemaphores(&m_sync.render_finish)
-						.setCommandBufferCount(1)
-						.setPWaitDstStageMask(&m_wait_stage);
+						.setCommandBufferCount(1);
+					if (!m_offscreen.has_value()) {
+						m_submit_info
+							.setWaitSemaphoreCount(1)
+							.setSignalSemaphoreCount(1)
+							.setPWaitDstStageMask(&m_wait_stage);
+					}
 
 					m_command_pool = vk::Device(*m_device).createCommandPool(
 						vk::CommandPoolCreateInfo()
 						.setQueueFamilyIndex(m_device->get_queue_familys().graphic.value().index)
 						.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer)
 					);
-					
+					if (ci.profile) m_profiler.emplace(m_device);
+					// command pools are externally synchronized, every worker records from its own
+					m_record.thread_pool = ci.thread_pool;
+					if (m_record.thread_pool != nullptr) {
+						for (core::ull_t i = 0; i < m_record.thread_pool->size(); ++i) {
+							m_record.pools.push_back(vk::Device(*m_device).createCommandPool(
+								vk::CommandPoolCreateInfo()
+								.setQueueFamilyIndex(m_device->get_queue_familys().graphic.value().index)
+							));
+						}
+					}
 
 					build(m_vsync);
 				}
 				~window_t() {
 					clean();
 					
+					for (const auto& iter : m_record.pools) vk::Device(*m_device).destroyCommandPool(iter);
 					vk::Device(*m_device).destroyCommandPool(m_command_pool);
-					vk::Device(*m_device).destroySemaphore(m_sync.render_finish);
-					vk::Device(*m_device).destroySemaphore(m_sync.present_available);
+					for (const auto& iter : m_sync.present_available) vk::Device(*m_device).destroySemaphore(iter);
+					for (const auto& iter : m_sync.fences) vk::Device(*m_device).destroyFence(iter);
 
 					vk::Device(*m_device).destroyRenderPass(m_render_pass);
-					vk::Instance(*m_device).destroySurfaceKHR(m_surface);
+					if (!m_offscreen.has_value()) vk::Instance(*m_device).destroySurfaceKHR(m_surface);
 				}
+				// the old resources are retired, they are destroyed once the frames using them have completed
 				void rebuild(bool vsync = true) {
-					clean();
+					retire();
 					build(vsync);
 				}
+				// feed with the e_resize / e_rect extent of the window_group_t, a surface window is rebuilt by the next run()
+				void resize(vk::Extent2D const& extent) {
+					if (m_offscreen.has_value()) {
+						m_offscreen.value().extent = extent;
+						rebuild(m_vsync);
+						return;
+					}
+					m_resize_extent = extent;
+				}
+				decltype(auto) is_offscreen() const { return m_offscreen.has_value(); }
+				decltype(auto) frame_count() const { return static_cast<std::uint32_t>(m_sync.fences.size()); }
+				// the frame slot the next run() submits, render funcs recorded for it read the per frame resources of this slot
+				decltype(auto) frame_slot() const { return m_sync.frame; }
+				/*
+					waits until the last frame submitted from frame_slot() has completed, the other frames stay in flight
+					call it before the host rewrites the per frame resources of the slot, run() calls it too
+				*/
+				decltype(auto) wait_frame() const {
+					CW_TRACE_ZONE("window_t::wait_frame");
+					vk::Device(*m_device).waitForFences({ m_sync.fences[m_sync.frame] }, VK_TRUE, UINT64_MAX);
+					m_device->retire_timeline(m_sync.values[m_sync.frame]);
+					return m_sync.frame;
+				}
 				void run(bool check_active = true) {
+					CW_TRACE_ZONE("window_t::run");
 					if (check_active && !is_active()) return;
-					auto result = acquire_next_image(m_sync.present_available);
-					if (result.first) rebuild(m_vsync);
-					m_sync.current_index = result.second;
-					m_submit_info.setPCommandBuffers(&m_execute_cmds[m_sync.current_index]);
-					m_submit_queue.submit({ m_submit_info }, nullptr);
-					if(present(m_sync.current_index, m_sync.render_finish)) rebuild(m_vsync);
+					poll_capture();
+					if (m_offscreen.has_value()) {
+						run_offscreen();
+						++m_frame;
+						if (m_profile_log_interval != 0 && m_frame % m_profile_log_interval == 0) { log_gpu_timings(std::cout); log_latency(std::cout); }
+						return;
+					}
+					auto frame = wait_frame();
+					auto result = acquire_next_image(m_sync.present_available[frame]);
+					// out of date, no image was acquired and the semaphore stays unsignaled, the next run() draws into the new swapchain
+					if (!result.second.has_value()) { rebuild(m_vsync); return; }
+					// a suboptimal image is still acquired, it is drawn and presented before the swapchain is replaced
+					m_sync.current_index = result.second.value();
+					submit_frame();
+					if (present(m_sync.current_index, m_sync.render_finish[m_sync.current_index]) || result.first) rebuild(m_vsync);
+					record_latency();
+					++m_frame;
+					if (m_profile_log_interval != 0 && m_frame % m_profile_log_interval == 0) { log_gpu_timings(std::cout); log_latency(std::cout); }
 				}
 				//decltype(auto) build_default_cmds() {
 				//	m_default_cmds = vk::Device(*m_device).allocateCommandBuffers(
@@ -207,42 +319,468 @@ namespace cw {
 				//	vk::Device(*m_device).freeCommandBuffers(m_command_pool, m_default_cmds);
 				//	m_default_cmds.clear();
 				//}
+				// replaces every render func and records them, store = false drops the funcs once recorded, the next record() leaves them out
 				void caculate(std::vector<render_func_t> const& render_funcs, bool store = true) {
-					m_render_funcs = render_funcs;
+					for (auto& iter : m_render_slots) retire_slot(iter);
+					m_render_slots.clear();
+					for (const auto& iter : render_funcs) m_render_slots.push_back({ ++m_last_handle, iter });
+					// the frames in flight may still execute the primary command buffers, they are replaced instead of reset
+					if (!m_default_cmds.empty()) renew_primary();
+					record_all();
+					if (!store) for (auto& iter : m_render_slots) iter.func = nullptr;
+				}
+				// records the render funcs again into new command buffers without waiting for the frames in flight,
+				// for state baked into the commands such as push constants, the old command buffers go to the deletion queue
+				void record() {
+					if (m_default_cmds.empty()) return;
+					renew_primary();
+					record_all();
+				}
+				/*
+					drawn after the render funcs already added, recording on a thread pool without profiling only records the new func
+					and the primary command buffers, which just execute the secondary ones, otherwise everything is recorded again
+				*/
+				render_handle_t add_render_func(render_func_t const& func) {
+					assert(func);
+					m_render_slots.push_back({ ++m_last_handle, func });
+					if (m_default_cmds.empty()) return m_last_handle;
+					if (is_incremental_record()) {
+						record_secondary(m_render_slots.size() - 1);
+						renew_primary();
+						record_primary();
+					}
+					else record();
+					return m_last_handle;
+				}
+				void remove_render_func(render_handle_t handle) {
+					auto iter = std::find_if(m_render_slots.begin(), m_render_slots.end(), [handle](render_slot_t const& slot) { return slot.handle == handle; });
+					if (iter == m_render_slots.end()) return;
+					retire_slot(*iter);
+					m_render_slots.erase(iter);
+					if (m_default_cmds.empty()) return;
+					if (is_incremental_record()) {
+						renew_primary();
+						record_primary();
+					}
+					else record();
+				}
+				decltype(auto) render_func_count() const { return m_render_slots.size(); }
+				// recorded before the render pass begins (compute dispatches, copies, barriers), applied when the command buffers are recorded next
+				void set_prepass(std::vector<render_func_t> const& prepass_funcs) { m_prepass_funcs = prepass_funcs; }
+				decltype(auto) is_multithread_record() const { return m_record.thread_pool != nullptr; }
+				// copy the next frame_count frames back to the host through a ring of readback buffers,
+				// callback is called from run() once a copy has completed, frame_count = max keeps capturing until stop_capture()
+				void capture(capture_func_t const& callback, std::uint32_t frame_count = 1, std::uint32_t ring_size = 3) {
+					assert(func::is_capture_format(m_color.surface_format.format) && ring_size > 0);
+					if (!m_offscreen.has_value() && !(func::find_surface_image_usage(*m_device, m_surface) & vk::ImageUsageFlagBits::eTransferSrc)) {
+						std::cerr << "surface images can't be used as transfer source, capture is ignored" << std::endl;
+						return;
+					}
+					if (m_capture.ring_size != ring_size) {
+						flush_capture();
+						clean_capture_slots();
+						m_capture.ring_size = ring_size;
+					}
+					m_capture.callback = callback;
+					m_capture.remaining = frame_count;
+				}
+				void stop_capture() { m_capture.remaining = 0; }
+				// wait for the copies still in flight and hand them over
+				void flush_capture() {
+					while (!m_capture.pending.empty()) {
+						vk::Device(*m_device).waitForFences({ m_capture.slots[m_capture.pending.front()].fence }, VK_TRUE, UINT64_MAX);
+						deliver_capture();
+					}
+				}
+				// frames skipped because every readback buffer was busy
+				decltype(auto) capture_dropped() const { return m_capture.dropped; }
+				decltype(auto) frame() const { return m_frame; }
+				// gpu time of the render pass and of every render_func_t, empty unless window_ci_t::profile is set
+				decltype(auto) gpu_timings() const { return m_profiler.has_value() ? m_profiler.value().timings() : std::vector<gpu_pass_timing_t>(); }
+				void log_gpu_timings(std::ostream& os) const { if (m_profiler.has_value()) m_profiler.value().log(os); }
+				// log the gpu timings and the present latency every interval frames, 0 turns it off
+				void set_profile_log(std::uint32_t interval) { m_profile_log_interval = interval; }
+				decltype(auto) present_policy() const { return m_present_policy.has_value() ? m_present_policy.value() : (m_vsync ? present_policy_e::e_tear_free : present_policy_e::e_lowest_latency); }
+				void set_present_policy(present_policy_e policy) {
+					m_present_policy = policy;
+					if (!m_offscreen.has_value()) rebuild(m_vsync);
+				}
+				// the mode the swapchain was actually created with
+				decltype(auto) present_mode() const { return m_present_mode; }
+				decltype(auto) image_count() const { return static_cast<std::uint32_t>(m_color.images.size()); }
+				// call when input is sampled, the next present closes the measurement
+				void mark_input() { if (!m_latency_input.has_value()) m_latency_input = std::chrono::steady_clock::now(); }
+				// one entry per present mode used so far, the display scanout after the present is not included
+				decltype(auto) latencies() const { return (m_latencies); }
+				void log_latency(std::ostream& os) const {
+					for (const auto& iter : m_latencies) {
+						os << vk::to_string(iter.mode) << " : last " << iter.last << "ms, average " << iter.average << "ms, max " << iter.max << "ms (" << iter.sample_count << " samples)" << std::endl;
+					}
+				}
+				// cached, a pending resize is reported before the swapchain follows it
+				decltype(auto) extent() const {
+					if (m_offscreen.has_value()) return m_offscreen.value().extent;
+					return m_resize_extent.has_value() ? m_resize_extent.value() : m_last_extent;
+				}
+
+				operator vk::RenderPass() const { return m_render_pass; }
+			private:
+				// a render func and, when recorded on the thread pool, its secondary command buffer for every primary one
+				struct render_slot_t {
+					render_handle_t handle = 0;
+					render_func_t func;
+					std::vector<vk::CommandBuffer> cmds;
+					std::vector<std::uint32_t> pools; // the worker pool cmds[i] came from
+				};
+				struct depth_stencil_t {
+					vk::Format format;
+					vk::Image image;
+					vk::DeviceMemory memory;
+					vk::ImageView view;
+				};
+				struct capture_slot_t {
+					buffer_t buffer;
+					vk::CommandBuffer cmd;
+					vk::Fence fence;
+					bool pending = false;
+					std::uint64_t frame = 0;
+					vk::Extent2D extent;
+				};
+				void build_surface_target(window_ci_t const& ci) {
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+					m_surface = vk::Instance(*m_device).createWin32SurfaceKHR(
+						vk::Win32SurfaceCreateInfoKHR()
+						.setHinstance(ci.hinstance)
+						.setHwnd(ci.hwnd)
+					);
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+					m_surface = vk::Instance(*m_device).createXcbSurfaceKHR(
+						vk::XcbSurfaceCreateInfoKHR()
+						.setConnection(ci.xcb_connection)
+						.setWindow(ci.xcb_window)
+					);
+#endif
+					assert(m_surface != VK_NULL_HANDLE);
+					m_support_present_modes = func::find_surface_present_modes(*m_device, m_surface, std::nullopt).value();
+					m_support_presents = func::get_surface_supports(*m_device, m_surface);
+
+					const auto& familys = m_device->get_queue_familys();
+					if (familys.graphic.has_value() && m_support_presents[familys.graphic.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.graphic.value().index, 0);
+					else if (familys.transfer.has_value() && m_support_presents[familys.transfer.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.transfer.value().index, 0);
+					else if (familys.compute.has_value() && m_support_presents[familys.compute.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.compute.value().index, 0);
+					else if (familys.sparse_binding.has_value() && m_support_presents[familys.sparse_binding.value().index]) m_present_queue = vk::Device(*m_device).getQueue(familys.sparse_binding.value().index, 0);
+					else assert(0);
+					assert(m_present_queue != VK_NULL_HANDLE);
+
+					if (familys.graphic.has_value() && m_support_presents[familys.graphic.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.graphic.value().index, 0);
+					else if (familys.transfer.has_value() && m_support_presents[familys.transfer.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.transfer.value().index, 0);
+					else if (familys.compute.has_value() && m_support_presents[familys.compute.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.compute.value().index, 0);
+					else if (familys.sparse_binding.has_value() && m_support_presents[familys.sparse_binding.value().index]) m_submit_queue = vk::Device(*m_device).getQueue(familys.sparse_binding.value().index, 0);
+					else assert(0);
+					assert(m_submit_queue != VK_NULL_HANDLE);
+
+					m_color.surface_format = func::find_surface_formats(*m_device, m_surface).value()[0];
+				}
+				void build_offscreen_target() {
+					const auto& familys = m_device->get_queue_familys();
+					assert(familys.graphic.has_value());
+					m_submit_queue = vk::Device(*m_device).getQueue(familys.graphic.value().index, 0);
+					assert(m_submit_queue != VK_NULL_HANDLE);
+					m_color.surface_format = vk::SurfaceFormatKHR().setFormat(m_offscreen.value().format).setColorSpace(vk::ColorSpaceKHR::eSrgbNonlinear);
+				}
+				void build_offscreen_images() {
+					for (std::uint32_t i = 0; i < m_offscreen.value().image_count; ++i) {
+						auto image = vk::Device(*m_device).createImage(
+							vk::ImageCreateInfo()
+							.setImageType(vk::ImageType::e2D)
+							.setFormat(m_color.surface_format.format)
+							.setExtent({ m_last_extent.width, m_last_extent.height, 1 })
+							.setMipLevels(1)
+							.setArrayLayers(1)
+							.setSamples(vk::SampleCountFlagBits::e1)
+							.setTiling(vk::ImageTiling::eOptimal)
+							.setUsage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc)
+						);
+						auto memReqs = vk::Device(*m_device).getImageMemoryRequirements(image);
+						auto memory = m_device->allocate_memory(memReqs, vk::MemoryPropertyFlagBits::eDeviceLocal);
+						vk::Device(*m_device).bindImageMemory(image, memory, 0);
+						m_color.images.push_back(image);
+						m_color.memories.push_back(memory);
+					}
+				}
+				// every frame slot owns an image, it is only reused once its previous frame has completed
+				void run_offscreen() {
+					m_sync.current_index = wait_frame();
+					submit_frame();
+				}
+				// submits the command buffer of (frame slot, current image) and moves on to the next frame slot
+				void submit_frame() {
+					auto frame = m_sync.frame;
+					auto index = cmd_index(frame, m_sync.current_index);
+					auto fence = m_sync.fences[frame];
+					vk::Device(*m_device).resetFences({ fence });
+					m_sync.values[frame] = m_device->advance_timeline();
+					m_sync.frame = (frame + 1) % frame_count();
+					m_submit_info.setPCommandBuffers(&m_execute_cmds[index]);
+					if (!m_offscreen.has_value()) {
+						m_submit_info
+							.setPWaitSemaphores(&m_sync.present_available[frame])
+							.setPSignalSemaphores(&m_sync.render_finish[m_sync.current_index]);
+					}
+					if (m_profiler.has_value()) {
+						m_profiler.value().collect(index);
+						m_profiler.value().submitted(index);
+					}
+					auto slot = acquire_capture_slot();
+					if (slot == nullptr) { m_submit_queue.submit({ m_submit_info }, fence); return; }
+					// the copy is a second submission, it takes over the render_finish signal so present waits for it too
+					record_capture(*slot, m_color.images[m_sync.current_index]);
+					auto render_info = vk::SubmitInfo(m_submit_info)
+						.setSignalSemaphoreCount(0)
+						.setPSignalSemaphores(nullptr);
+					auto copy_info = vk::SubmitInfo()
+						.setCommandBufferCount(1)
+						.setPCommandBuffers(&slot->cmd)
+						.setSignalSemaphoreCount(m_submit_info.signalSemaphoreCount)
+						.setPSignalSemaphores(m_submit_info.pSignalSemaphores);
+					m_submit_queue.submit({ render_info }, fence);
+					m_submit_queue.submit({ copy_info }, slot->fence);
+				}
+				void build_capture_slots() {
+					auto cmds = vk::Device(*m_device).allocateCommandBuffers(
+						vk::CommandBufferAllocateInfo()
+						.setCommandPool(m_command_pool)
+						.setLevel(vk::CommandBufferLevel::ePrimary)
+						.setCommandBufferCount(m_capture.ring_size)
+					);
+					for (const auto& cmd : cmds) {
+						capture_slot_t slot;
+						slot.buffer = buffer_t(
+							buffer_ci_t()
+							.set_device(m_device)
+							.set_usage_flags(vk::BufferUsageFlagBits::eTransferDst)
+							.set_intent(memory_intent_e::e_readback)
+							.set_byte(static_cast<vk::DeviceSize>(m_last_extent.width) * m_last_extent.height * 4)
+						);
+						slot.cmd = cmd;
+						slot.fence = vk::Device(*m_device).createFence(vk::FenceCreateInfo());
+						m_capture.slots.push_back(std::move(slot));
+					}
+				}
+				void clean_capture_slots() {
+					assert(m_capture.pending.empty());
+					for (auto& iter : m_capture.slots) {
+						vk::Device(*m_device).destroyFence(iter.fence);
+						vk::Device(*m_device).freeCommandBuffers(m_command_pool, { iter.cmd });
+					}
+					m_capture.slots.clear();
+				}
+				decltype(auto) acquire_capture_slot() {
+					capture_slot_t* result = nullptr;
+					if (!m_capture.callback || m_capture.remaining == 0) return result;
+					if (m_capture.slots.empty()) build_capture_slots();
+					for (auto& iter : m_capture.slots) {
+						if (iter.pending) continue;
+						if (m_capture.remaining != std::numeric_limits<std::uint32_t>::max()) --m_capture.remaining;
+						result = &iter;
+						return result;
+					}
+					// every readback buffer is still in flight, skip this frame rather than stall
+					++m_capture.dropped;
+					return result;
+				}
+				void record_capture(capture_slot_t& slot, vk::Image image) {
+					auto final_layout = m_offscreen.has_value() ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+					auto range = vk::ImageSubresourceRange()
+						.setAspectMask(vk::ImageAspectFlagBits::eColor)
+						.setLevelCount(1)
+						.setLayerCount(1);
+					slot.cmd.reset(vk::CommandBufferResetFlags());
+					slot.cmd.begin(vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+					slot.cmd.pipelineBarrier(
+						vk::PipelineStageFlagBits::eColorAttachmentOutput,
+						vk::PipelineStageFlagBits::eTransfer,
+						vk::DependencyFlags(),
+						nullptr,
+						nullptr,
+						{ vk::ImageMemoryBarrier()
+							.setOldLayout(final_layout)
+							.setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+							.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+							.setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+							.setImage(image)
+							.setSubresourceRange(range) }
+					);
+					slot.cmd.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, slot.buffer, {
+						vk::BufferImageCopy()
+						.setImageSubresource(vk::ImageSubresourceLayers().setAspectMask(vk::ImageAspectFlagBits::eColor).setLayerCount(1))
+						.setImageExtent({ m_last_extent.width, m_last_extent.height, 1 }) }
+					);
+					if (!m_offscreen.has_value()) {
+						slot.cmd.pipelineBarrier(
+							vk::PipelineStageFlagBits::eTransfer,
+							vk::PipelineStageFlagBits::eBottomOfPipe,
+							vk::DependencyFlags(),
+							nullptr,
+							nullptr,
+							{ vk::ImageMemoryBarrier()
+								.setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
+								.setNewLayout(final_layout)
+								.setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
+								.setDstAccessMask(vk::AccessFlags())
+								.setImage(image)
+								.setSubresourceRange(range) }
+						);
+					}
+					slot.cmd.pipelineBarrier(
+						vk::PipelineStageFlagBits::eTransfer,
+						vk::PipelineStageFlagBits::eHost,
+						vk::DependencyFlags(),
+						nullptr,
+						{ vk::BufferMemoryBarrier()
+							.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+							.setDstAccessMask(vk::AccessFlagBits::eHostRead)
+							.setBuffer(slot.buffer)
+							.setSize(VK_WHOLE_SIZE) },
+						nullptr
+					);
+					slot.cmd.end();
+					slot.frame = m_frame;
+					slot.extent = m_last_extent;
+					slot.pending = true;
+					vk::Device(*m_device).resetFences({ slot.fence });
+					m_capture.pending.push_back(static_cast<std::uint32_t>(&slot - m_capture.slots.data()));
+				}
+				void deliver_capture() {
+					auto& slot = m_capture.slots[m_capture.pending.front()];
+					m_capture.pending.pop_front();
+					capture_frame_t frame;
+					frame.frame = slot.frame;
+					frame.extent = slot.extent;
+					frame.format = m_color.surface_format.format;
+					frame.pixels = core::memory_view_t(slot.buffer.byte(), slot.buffer.map());
+					// readback memory may be cached without being coherent, the copy isn't visible to the host before that
+					if ((slot.buffer.memory_flags() & vk::MemoryPropertyFlagBits::eHostCoherent) == vk::MemoryPropertyFlags()) {
+						vk::Device(*m_device).invalidateMappedMemoryRanges({
+							vk::MappedMemoryRange()
+							.setMemory(slot.buffer)
+							.setOffset(0)
+							.setSize(VK_WHOLE_SIZE) }
+						);
+					}
+					if (m_capture.callback) m_capture.callback(frame);
+					slot.buffer.unmap();
+					slot.pending = false;
+				}
+				// the passes of the profiler are the slot indices, so with it every change records everything
+				bool is_incremental_record() const { return m_record.thread_pool != nullptr && !m_profiler.has_value(); }
+				bool is_secondary_record() const { return m_record.thread_pool != nullptr && !m_render_slots.empty(); }
+				// every render func, after dropping the ones caculate(..., false) let go
+				void record_all() {
+					for (auto& iter : m_render_slots) if (!iter.func) retire_slot(iter);
+					m_render_slots.erase(std::remove_if(m_render_slots.begin(), m_render_slots.end(), [](render_slot_t const& slot) { return !slot.func; }), m_render_slots.end());
+					if (m_profiler.has_value()) m_profiler.value().resize(static_cast<std::uint32_t>(m_default_cmds.size()), static_cast<std::uint32_t>(m_render_slots.size()));
+					if (is_secondary_record()) record_secondary(0);
+					record_primary();
+				}
+				void record_primary() {
 					vk::Rect2D area = { {0,0},m_last_extent };
-					for (auto& iter : m_default_cmds) iter.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
-					for (int i = 0; i < m_default_cmds.size(); ++i) {
+					auto secondary = is_secondary_record();
+					for (std::uint32_t i = 0; i < m_default_cmds.size(); ++i) {
+						auto frame = cmd_frame(i);
+						m_default_cmds[i].reset(vk::CommandBufferResetFlagBits::eReleaseResources);
 						m_default_cmds[i].begin(vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eSimultaneousUse));
+						for (const auto& func : m_prepass_funcs) func(m_default_cmds[i], area, frame);
+						if (m_profiler.has_value()) m_profiler.value().begin(m_default_cmds[i], i);
 						m_default_cmds[i].beginRenderPass(
 							vk::RenderPassBeginInfo()
 							.setRenderPass(m_render_pass)
-							.setFramebuffer(m_framebuffers[i])
+							.setFramebuffer(m_framebuffers[cmd_image(i)])
 							.setClearValueCount(m_clear_values.size())
 							.setPClearValues(m_clear_values.data())
 							.setRenderArea(area)
-							, vk::SubpassContents::eInline
+							, secondary ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline
 						);
-						for (const auto& func : m_render_funcs) func(m_default_cmds[i], area);
-						//if (m_render_func != nullptr) m_render_func(m_default_cmds[i], area);
+						if (secondary) {
+							m_record.execute.clear();
+							for (const auto& iter : m_render_slots) if (i < iter.cmds.size() && iter.cmds[i]) m_record.execute.push_back(iter.cmds[i]);
+							if (!m_record.execute.empty()) m_default_cmds[i].executeCommands(static_cast<std::uint32_t>(m_record.execute.size()), m_record.execute.data());
+						}
+						for (std::uint32_t j = 0; !secondary && j < m_render_slots.size(); ++j) {
+							if (m_profiler.has_value()) m_profiler.value().begin_pass(m_default_cmds[i], i, j);
+							m_render_slots[j].func(m_default_cmds[i], area, frame);
+							if (m_profiler.has_value()) m_profiler.value().end_pass(m_default_cmds[i], i, j);
+						}
 						m_default_cmds[i].endRenderPass();
+						if (m_profiler.has_value()) m_profiler.value().end(m_default_cmds[i], i);
 						m_default_cmds[i].end();
 					}
-					if (!store) m_render_funcs.clear();
-					//if (!store) m_render_func = nullptr;
 					m_execute_cmds = m_default_cmds;
 				}
-				decltype(auto) extent() const { return func::get_surface_extent(*m_device, m_surface); }
-
-				operator vk::RenderPass() const { return m_render_pass; }
-			private:
-				void build(bool vsync = true) {
-					m_vsync = vsync;
-					m_last_extent = func::get_surface_extent(*m_device, m_surface);
+				// one secondary command buffer per (render func, primary command buffer) of the slots from first on, recorded on the workers
+				void record_secondary(std::size_t first) {
+					vk::Rect2D area = { {0,0},m_last_extent };
+					auto count = m_default_cmds.size();
+					for (auto i = first; i < m_render_slots.size(); ++i) {
+						retire_slot(m_render_slots[i]);
+						m_render_slots[i].cmds.assign(count, nullptr);
+						m_render_slots[i].pools.assign(count, 0);
+					}
+					m_record.thread_pool->parallel_for((m_render_slots.size() - first) * count, [this, &area, first, count](core::ull_t index, core::ull_t worker) {
+						auto slot_index = first + index / count;
+						auto primary = static_cast<std::uint32_t>(index % count);
+						auto& slot = m_render_slots[slot_index];
+						auto info = vk::CommandBufferAllocateInfo()
+							.setCommandPool(m_record.pools[worker])
+							.setLevel(vk::CommandBufferLevel::eSecondary)
+							.setCommandBufferCount(1);
+						// the pointer overload fills cmd in place of returning a std::vector
+						vk::CommandBuffer cmd;
+						if (vk::Device(*m_device).allocateCommandBuffers(&info, &cmd) != vk::Result::eSuccess) {
+							std::cerr << "can't allocate a secondary command buffer, render func " << slot.handle << " is skipped" << std::endl;
+							return;
+						}
+						auto inheritance = vk::CommandBufferInheritanceInfo()
+							.setRenderPass(m_render_pass)
+							.setSubpass(0)
+							.setFramebuffer(m_framebuffers[cmd_image(primary)]);
+						cmd.begin(
+							vk::CommandBufferBeginInfo()
+							.setFlags(vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eSimultaneousUse)
+							.setPInheritanceInfo(&inheritance)
+						);
+						if (m_profiler.has_value()) m_profiler.value().begin_pass(cmd, primary, static_cast<std::uint32_t>(slot_index));
+						slot.func(cmd, area, cmd_frame(primary));
+						if (m_profiler.has_value()) m_profiler.value().end_pass(cmd, primary, static_cast<std::uint32_t>(slot_index));
+						cmd.end();
+						slot.cmds[primary] = cmd;
+						slot.pools[primary] = static_cast<std::uint32_t>(worker);
+					});
+				}
+				void record_latency() {
+					if (!m_latency_input.has_value()) return;
+					auto value = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_latency_input.value()).count();
+					m_latency_input.reset();
+					auto iter = std::find_if(m_latencies.begin(), m_latencies.end(), [this](present_latency_t const& latency) { return latency.mode == m_present_mode; });
+					if (iter == m_latencies.end()) { m_latencies.push_back(present_latency_t()); iter = m_latencies.end() - 1; iter->mode = m_present_mode; }
+					iter->last = value;
+					iter->max = (std::max)(iter->max, value);
+					iter->average += (value - iter->average) / static_cast<double>(++iter->sample_count);
+				}
+				// hand over every copy which has completed, never waits
+				void poll_capture() {
+					while (!m_capture.pending.empty() && vk::Device(*m_device).getFenceStatus(m_capture.slots[m_capture.pending.front()].fence) == vk::Result::eSuccess) deliver_capture();
+				}
+				void build_swapchain() {
+					auto capability = vk::PhysicalDevice(*m_device).getSurfaceCapabilitiesKHR(m_surface);
+					m_last_extent = capability.currentExtent;
+					m_present_mode = func::choose_present_mode(m_support_present_modes, present_policy());
 					vk::SwapchainKHR old_swapchain = m_swapchain;
 					m_swapchain = vk::Device(*m_device).createSwapchainKHR(
 						vk::SwapchainCreateInfoKHR()
 						.setSurface(m_surface)
-						.setMinImageCount(func::find_surface_image_count(*m_device, m_surface))
+						.setMinImageCount(func::choose_present_image_count(capability, m_present_mode, present_policy()))
 						.setImageFormat(m_color.surface_format.format)
 						.setImageColorSpace(m_color.surface_format.colorSpace)
 						.setImageExtent(m_last_extent)
@@ -252,13 +790,21 @@ namespace cw {
 						.setImageSharingMode(vk::SharingMode::eExclusive)
 						.setQueueFamilyIndexCount(0)
 						.setPQueueFamilyIndices(nullptr)
-						.setPresentMode(m_vsync ? m_support_present_modes.front() : m_support_present_modes.back())
+						.setPresentMode(m_present_mode)
 						.setClipped(VK_TRUE)
 						.setCompositeAlpha(func::find_surface_composite_alphas(*m_device, m_surface).value()[0])
 						.setOldSwapchain(old_swapchain)
 					);
 					assert(m_color.images.empty());
 					m_color.images = vk::Device(*m_device).getSwapchainImagesKHR(m_swapchain);
+				}
+				void build(bool vsync = true) {
+					m_vsync = vsync;
+					if (m_offscreen.has_value()) {
+						m_last_extent = m_offscreen.value().extent;
+						build_offscreen_images();
+					}
+					else build_swapchain();
 					for (const auto& iter : m_color.images) {
 						m_color.views.push_back(
 							vk::Device(*m_device).createImageView(
@@ -294,11 +840,7 @@ namespace cw {
 							.setUsage(vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransferSrc)
 						);
 						auto memReqs = vk::Device(*m_device).getImageMemoryRequirements(m_depth_stencil.value().image);
-						m_depth_stencil.value().memory = vk::Device(*m_device).allocateMemory(
-							vk::MemoryAllocateInfo()
-							.setAllocationSize(memReqs.size)
-							.setMemoryTypeIndex(func::find_memory_index(*m_device, memReqs.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal).value())
-						);
+						m_depth_stencil.value().memory = m_device->allocate_memory(memReqs, vk::MemoryPropertyFlagBits::eDeviceLocal);
 						vk::Device(*m_device).bindImageMemory(m_depth_stencil.value().image, m_depth_stencil.value().memory, 0);
 						auto imageViewCI =
 							vk::ImageViewCreateInfo()
@@ -336,54 +878,117 @@ namespace cw {
 						);
 					}
 					
+					// present waits for the semaphore of its image, a frame slot can't own it since the image outlives the slot's fence
+					if (!m_offscreen.has_value()) {
+						for (std::size_t i = 0; i < m_color.images.size(); ++i) m_sync.render_finish.push_back(vk::Device(*m_device).createSemaphore(vk::SemaphoreCreateInfo()));
+					}
+
 					//m_execute_cmds = build_default_cmds();
 					m_default_cmds = vk::Device(*m_device).allocateCommandBuffers(
 						vk::CommandBufferAllocateInfo()
 						.setCommandPool(m_command_pool)
 						.setLevel(vk::CommandBufferLevel::ePrimary)
-						.setCommandBufferCount(m_color.images.size())
+						.setCommandBufferCount(cmd_count())
 					);
-					caculate(m_render_funcs, true);
+					record_all();
 				}
-				void clean() {
-					//clean_default_cmds();
-					vk::Device(*m_device).waitIdle();
-					vk::Device(*m_device).freeCommandBuffers(m_command_pool, m_default_cmds);
+				/*
+					a surface window has a primary command buffer per (frame slot, image), the slot picks the per frame resources
+					and the image is only known once acquired, an offscreen frame slot always renders into its own image
+				*/
+				decltype(auto) cmd_count() const { return static_cast<std::uint32_t>(m_offscreen.has_value() ? frame_count() : frame_count() * m_color.images.size()); }
+				decltype(auto) cmd_index(std::uint32_t frame, std::uint32_t image) const { return m_offscreen.has_value() ? frame : frame * image_count() + image; }
+				decltype(auto) cmd_frame(std::uint32_t index) const { return m_offscreen.has_value() ? index : index / image_count(); }
+				decltype(auto) cmd_image(std::uint32_t index) const { return m_offscreen.has_value() ? index : index % image_count(); }
+				// primary and secondary command buffers
+				void retire_cmds() {
+					retire_primary();
+					for (auto& iter : m_render_slots) retire_slot(iter);
+				}
+				void retire_primary() {
+					if (!m_default_cmds.empty()) {
+						m_device->defer_destroy([device = m_device, pool = m_command_pool, cmds = std::move(m_default_cmds)]() { vk::Device(*device).freeCommandBuffers(pool, cmds); });
+					}
 					m_default_cmds.clear();
-					
-					m_execute_cmds.clear();
-
-					for (const auto& iter : m_framebuffers) vk::Device(*m_device).destroyFramebuffer(iter);
-					m_framebuffers.clear();
+				}
+				// new primary command buffers in place of the ones the frames in flight may still execute
+				void renew_primary() {
+					auto count = static_cast<std::uint32_t>(m_default_cmds.size());
+					retire_primary();
+					m_default_cmds = vk::Device(*m_device).allocateCommandBuffers(
+						vk::CommandBufferAllocateInfo()
+						.setCommandPool(m_command_pool)
+						.setLevel(vk::CommandBufferLevel::ePrimary)
+						.setCommandBufferCount(count)
+					);
+				}
+				// secondary command buffers of one render func
+				void retire_slot(render_slot_t& slot) {
+					if (slot.cmds.empty()) return;
+					m_device->defer_destroy([device = m_device, pools = m_record.pools, slot_pools = std::move(slot.pools), cmds = std::move(slot.cmds)]() {
+						for (std::size_t i = 0; i < cmds.size(); ++i) if (cmds[i]) vk::Device(*device).freeCommandBuffers(pools[slot_pools[i]], 1, &cmds[i]);
+					});
+					slot.cmds.clear();
+					slot.pools.clear();
+				}
+				// hand the current resources to the device's deletion queue, oldSwapchain stays valid for the next build_swapchain()
+				void retire() {
+					flush_capture();
+					clean_capture_slots();
+					retire_cmds();
+					for (const auto& iter : m_framebuffers) m_device->defer_destroy(iter);
 					if (m_depth_stencil.has_value()) {
-						vk::Device(*m_device).destroyImageView(m_depth_stencil.value().view);
-						vk::Device(*m_device).freeMemory(m_depth_stencil.value().memory);
-						vk::Device(*m_device).destroyImage(m_depth_stencil.value().image);
+						m_device->defer_destroy(m_depth_stencil.value().view);
+						m_device->defer_destroy(m_depth_stencil.value().image);
+						m_device->defer_destroy(m_depth_stencil.value().memory);
 					}
-					for (auto& iter : m_color.views) vk::Device(*m_device).destroyImageView(iter);
+					for (const auto& iter : m_color.views) m_device->defer_destroy(iter);
+					if (m_offscreen.has_value()) {
+						for (const auto& iter : m_color.images) m_device->defer_destroy(iter);
+						for (const auto& iter : m_color.memories) m_device->defer_destroy(iter);
+					}
+					for (const auto& iter : m_sync.render_finish) m_device->defer_destroy(iter);
+					if (m_swapchain) m_device->defer_destroy(m_swapchain);
 					m_color.images.clear();
+					m_color.memories.clear();
 					m_color.views.clear();
-					vk::Device(*m_device).destroySwapchainKHR(m_swapchain);
+					m_sync.render_finish.clear();
+					m_framebuffers.clear();
+					m_default_cmds.clear();
+					m_execute_cmds.clear();
+				}
+				void clean() {
+					retire();
+					m_device->flush_deferred();
 					m_swapchain = nullptr;
 				}
 
 				/*decltype(auto)*/ bool is_active() {
-					auto new_extent = vk::PhysicalDevice(*m_device).getSurfaceCapabilitiesKHR(m_surface).currentExtent;
-					if (new_extent.width == 0 || new_extent.height == 0) { m_last_extent = new_extent; return false; }
-					if (new_extent == m_last_extent) return true;
-					m_last_extent = new_extent;
-					rebuild(m_vsync);
-					return true;
-				}
-				/*decltype(auto)*/ std::pair<bool, std::uint32_t> acquire_next_image(vk::Semaphore signal) const {
-					std::pair<bool, std::uint32_t> result{ false, std::numeric_limits<std::uint32_t>::max() };
-					auto temp = vk::Device(*m_device).acquireNextImageKHR(m_swapchain, UINT64_MAX, signal, nullptr);
-					if ((temp.result == vk::Result::eErrorOutOfDateKHR) || (temp.result == vk::Result::eSuboptimalKHR)) result.first = true;
-					else assert(temp.result == vk::Result::eSuccess);
-					result.second = temp.value;
+					if (m_offscreen.has_value()) return m_last_extent.width != 0 && m_last_extent.height != 0;
+					if (m_resize_extent.has_value()) {
+						m_resize_extent.reset();
+						// one capability query per resize instead of one per frame
+						auto new_extent = func::get_surface_extent(*m_device, m_surface);
+						if (new_extent.width == 0 || new_extent.height == 0) { m_last_extent = new_extent; return false; }
+						if (new_extent != m_last_extent || m_framebuffers.empty()) rebuild(m_vsync);
+					}
+					return m_last_extent.width != 0 && m_last_extent.height != 0;
+				}
+				// first : the swapchain has to be rebuilt, second : the acquired image, empty when the swapchain is out of date
+				/*decltype(auto)*/ std::pair<bool, std::optional<std::uint32_t>> acquire_next_image(vk::Semaphore signal) const {
+					CW_TRACE_ZONE("window_t::acquire");
+					std::pair<bool, std::optional<std::uint32_t>> result{ true, std::nullopt };
+					try {
+						auto temp = vk::Device(*m_device).acquireNextImageKHR(m_swapchain, UINT64_MAX, signal, nullptr);
+						assert(temp.result == vk::Result::eSuccess || temp.result == vk::Result::eSuboptimalKHR);
+						result.first = temp.result == vk::Result::eSuboptimalKHR;
+						result.second = temp.value;
+					}
+					catch (vk::OutOfDateKHRError const&) {}
 					return result;
 				}
 				/*decltype(auto)*/ bool present(uint32_t imageIndex, vk::Semaphore wait_semaphore = nullptr) const {
+					CW_TRACE_ZONE("window_t::present");
 					auto present_info =
 						vk::PresentInfoKHR()
 						.setSwapchainCount(1)
@@ -398,36 +1003,40 @@ namespace cw {
 						if (result == vk::Result::eErrorOutOfDateKHR) return true;
 						else assert(result == vk::Result::eSuccess);
 					}
-					m_present_queue.waitIdle();
+					// no wait, the frame slot's fence tells run() when the resources of the frame can be reused
 					return false;
 				}
 			private:
 				const device_t* m_device = nullptr;
 				vk::SurfaceKHR m_surface;
 				bool m_vsync = true;
+				std::optional<present_policy_e> m_present_policy;
+				vk::PresentModeKHR m_present_mode = vk::PresentModeKHR::eFifo;
+				std::optional<std::chrono::steady_clock::time_point> m_latency_input;
+				std::vector<present_latency_t> m_latencies;
+				std::optional<window_offscreen_t> m_offscreen;
 				std::vector<vk::PresentModeKHR> m_support_present_modes;
 				std::vector<vk::Bool32> m_support_presents;
 				struct color_t {
 					vk::SurfaceFormatKHR surface_format;
 					std::vector<vk::Image> images;
 					std::vector<vk::ImageView> views;
+					std::vector<vk::DeviceMemory> memories; // offscreen only
 				}m_color;
-				struct depth_stencil_t {
-					vk::Format format;
-					vk::Image image;
-					vk::DeviceMemory memory;
-					vk::ImageView view;
-				};
 				std::optional<depth_stencil_t> m_depth_stencil;
 				vk::RenderPass m_render_pass;
 				vk::SwapchainKHR m_swapchain;
 				std::vector<vk::Framebuffer> m_framebuffers;
 				vk::Extent2D m_last_extent;
+				std::optional<vk::Extent2D> m_resize_extent; // set by resize(), consumed by is_active()
 
 				struct {
-					vk::Semaphore present_available;
-					vk::Semaphore render_finish;
-					std::uint32_t current_index;
+					std::vector<vk::Semaphore> present_available; // surface only, one per frame slot
+					std::vector<vk::Semaphore> render_finish; // surface only, one per image
+					std::uint32_t frame = 0; // frame slot of the next submission
+					std::uint32_t current_index = 0; // image of the last submission
+					std::vector<vk::Fence> fences; // one per frame slot
+					std::vector<std::uint64_t> values; // device timeline value of the last submission of each frame slot
 				}m_sync;
 				vk::Queue m_present_queue;
 				vk::Queue m_submit_queue;
@@ -437,7 +1046,26 @@ namespace cw {
 				vk::CommandPool m_command_pool;
 				std::vector<vk::CommandBuffer> m_default_cmds;
 				std::vector<vk::CommandBuffer> m_execute_cmds;
-				std::vector<render_func_t> m_render_funcs;
+				std::vector<render_slot_t> m_render_slots;
+				render_handle_t m_last_handle = 0;
+				std::vector<render_func_t> m_prepass_funcs;
+				std::uint64_t m_frame = 0;
+				std::optional<gpu_profiler_t> m_profiler;
+				struct {
+					core::thread_pool_t* thread_pool = nullptr;
+					std::vector<vk::CommandPool> pools; // one per worker of thread_pool
+					std::vector<vk::CommandBuffer> execute; // secondary command buffers of one image, kept so recording doesn't allocate
+				}m_record;
+				std::uint32_t m_profile_log_interval = 0;
+
+				struct {
+					capture_func_t callback;
+					std::uint32_t remaining = 0;
+					std::uint32_t ring_size = 3;
+					std::uint64_t dropped = 0;
+					std::vector<capture_slot_t> slots;
+					std::deque<std::uint32_t> pending; // slot indexes in submission order
+				}m_capture;
 				std::vector<vk::ClearValue> m_clear_values{
 					vk::ClearValue().setColor(vk::ClearColorValue().setFloat32({ 0.2f, 0.3f, 0.3f, 1.0f })),
 					vk::ClearValue().setDepthStencil(vk::ClearDepthStencilValue().setDepth(1.0f).setStencil(0))
@@ -1,6 +1,6 @@
 #version 450
 
-layout (binding = 1) uniform sampler2DArray sampler_array;
+layout (binding = 0) uniform sampler2DArray sampler_array;
 
 layout (location = 0) in vec3 in_uv;
 layout (location = 1) in vec4 in_color;
@@ -1,17 +1,26 @@
 #version 450
 
-layout (binding = 0) uniform UBO {
-	mat4 model;
-	mat4 view;
-	mat4 proj;
-}ubo;
+// glslangValidator -V snake.vert -o snake.vert.spv
+
+// baked when the pipeline is built, see specialization_t on the host
+layout (constant_id = 0) const uint grid_width = 30;
+layout (constant_id = 1) const uint grid_height = 20;
+layout (constant_id = 2) const float cell_scale = 0.2;
+layout (constant_id = 3) const float palette_r = 0.2;
+layout (constant_id = 4) const float palette_g = 1.0;
+layout (constant_id = 5) const float palette_b = 0.5;
+layout (constant_id = 6) const float palette_a = 0.8;
+
+// proj * view * model, premultiplied on the host
+layout (push_constant) uniform constant_t {
+	mat4 mvp;
+	uint lod;	// a cell of level lod covers 2^lod x 2^lod cells of the board
+}constant;
 
 layout (location = 0) in vec3 in_vert_pos;		// binding = 0
 layout (location = 1) in vec2 in_vert_uv;		// binding = 0
-layout (location = 2) in vec3 in_inst_pos;		// binding = 1
-layout (location = 3) in vec3 in_inst_scale;	// binding = 1
-layout (location = 4) in vec4 in_inst_color;	// binding = 1
-layout (location = 5) in uint in_inst_texid;	// binding = 1
+layout (location = 2) in uint in_inst_cell;		// binding = 1, y * width + x of the level
+layout (location = 3) in uint in_inst_texid;	// binding = 1
 
 layout (location = 0) out vec3 out_uv;			// vec3(u, v, texid)
 layout (location = 1) out vec4 out_color;
@@ -22,18 +31,11 @@ out gl_PerVertex {
 
 void main(){
 	out_uv = vec3(in_vert_uv, in_inst_texid);
-	out_color = in_inst_color;
-	mat4 tran = mat4(0.0);
-	tran[0].r = in_inst_scale.r;
-	tran[1].g = in_inst_scale.g;
-	tran[2].b = in_inst_scale.b;
-	tran[3].a = 1.0;
+	out_color = vec4(palette_r, palette_g, palette_b, palette_a);
 
-	mat4 mvp = ubo.proj * ubo.view * ubo.model;
+	uint width = (grid_width + (1u << constant.lod) - 1u) >> constant.lod;
+	float scale = cell_scale * float(1u << constant.lod);
+	vec2 cell = vec2(in_inst_cell % width, in_inst_cell / width);
 
-	gl_Position = mvp * ( vec4(in_inst_pos, 1.0) + tran * vec4(in_vert_pos, 1.0) );
-	
-	// gl_Position = in_inst_model * vec4(in_vert_pos, 1.0);
-
-	// gl_Position = ubo.proj * ubo.view * ubo.model * vec4(in_pos + in_inst_pos, 1.0);
-}
\ No newline at end of file
+	gl_Position = constant.mvp * vec4((cell + in_vert_pos.xy) * scale, in_vert_pos.z, 1.0);
+}
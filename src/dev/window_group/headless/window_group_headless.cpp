@@ -0,0 +1,20 @@
+#include "./window_group_headless.hpp"
+#include "./../../../../inc/core/trace.hpp"
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			window_group_headless_t::window_group_headless_t(const window_group_ci_t& create_info) : m_extent(create_info.m_rect.m_extent) {
+				window_group_t::m_is_active = true;
+			}
+			window_group_headless_t::~window_group_headless_t() {}
+			std::queue<event_t>& window_group_headless_t::update() {
+				CW_TRACE_ZONE("window_group_t::update");
+				while (!window_group_t::m_event_queue.empty()) { window_group_t::m_event_queue.pop(); }
+				return window_group_t::m_event_queue;
+			}
+			void window_group_headless_t::kill_active_priv() {}
+			std::optional<extent_t> window_group_headless_t::headless() const { return m_extent; }
+		}
+	}
+}
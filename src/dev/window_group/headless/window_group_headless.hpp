@@ -0,0 +1,21 @@
+#pragma once
+
+#include "./../../../../inc/dev/window_group/window_group.hpp"
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			// opens no window and sends no event, stays active until kill_active()
+			class window_group_headless_t : public window_group_t {
+			public:
+				window_group_headless_t(const window_group_ci_t& create_info);
+				virtual ~window_group_headless_t();
+				virtual std::queue<event_t>& update();
+				virtual void kill_active_priv();
+				virtual std::optional<extent_t> headless() const;
+			private:
+				extent_t m_extent;
+			};
+		}
+	}
+}
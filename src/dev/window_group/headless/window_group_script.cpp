@@ -0,0 +1,95 @@
+#include "./window_group_script.hpp"
+#include "./../../../../inc/core/trace.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			decltype(auto) to_key(const std::string& name) {
+				for (auto i = 0; i < static_cast<int>(key_e::e_null); ++i) {
+					if (to_string(static_cast<key_e>(i)) == name) return static_cast<key_e>(i);
+				}
+				return key_e::e_null;
+			}
+
+			window_group_script_t::window_group_script_t(const window_group_script_ci_t& create_info) : m_ci(create_info), m_start(std::chrono::steady_clock::now()), m_now(m_start) {
+				assert(std::is_sorted(m_ci.events.begin(), m_ci.events.end(), [](const auto& a, const auto& b) { return a.time < b.time; }));
+				auto closed = std::any_of(m_ci.events.begin(), m_ci.events.end(), [](const auto& iter) { return iter.event.etype == event_e::e_close; });
+				if (!closed) m_ci.events.push_back({ (m_ci.events.empty() ? std::chrono::milliseconds(0) : m_ci.events.back().time) + std::chrono::seconds(1), event_t{ event_e::e_close } });
+				window_group_t::m_is_active = true;
+			}
+			window_group_script_t::~window_group_script_t() {}
+			std::queue<event_t>& window_group_script_t::update() {
+				CW_TRACE_ZONE("window_group_t::update");
+				while (!window_group_t::m_event_queue.empty()) { window_group_t::m_event_queue.pop(); }
+				if (m_ci.replay == replay_e::e_max_speed) m_now += m_ci.frame_time;
+				else m_now = std::chrono::steady_clock::now();
+				for (; m_next < m_ci.events.size() && m_start + m_ci.events[m_next].time <= m_now; ++m_next) {
+					const auto& event = m_ci.events[m_next].event;
+					if (event.etype == event_e::e_resize) m_ci.extent = std::get<extent_t>(event.detail);
+					window_group_t::m_event_queue.push(event);
+					if (event.etype == event_e::e_close) {
+						window_group_t::m_is_active = false;
+						break;
+					}
+				}
+				return window_group_t::m_event_queue;
+			}
+			void window_group_script_t::kill_active_priv() {}
+			std::optional<extent_t> window_group_script_t::headless() const { return m_ci.extent; }
+			time_point_t window_group_script_t::now() const { return m_now; }
+		}
+		namespace func {
+			std::optional<std::vector<script_event_t>> parse_script(std::istream& is) {
+				std::vector<script_event_t> result;
+				std::string line;
+				for (core::ull_t number = 1; std::getline(is, line); ++number) {
+					std::istringstream words(line);
+					long long time;
+					std::string type, detail;
+					if (!(words >> time)) {
+						std::string first;
+						std::istringstream(line) >> first;
+						if (first.empty() || first[0] == '#') continue;
+						std::cerr << "can't parse the time of script line " << number << std::endl;
+						return std::nullopt;
+					}
+					words >> type >> detail;
+					event_t event;
+					if (type == "keydown" || type == "keyup") {
+						auto key = priv::to_key(detail);
+						if (key == key_e::e_null) { std::cerr << "can't find key \"" << detail << "\" of script line " << number << std::endl; return std::nullopt; }
+						event = event_t{ type == "keydown" ? event_e::e_keydown : event_e::e_keyup, key };
+					}
+					else if (type == "resize") {
+						// an empty extent can't be rendered to
+						std::istringstream extent(detail);
+						long long width = 0, height = 0;
+						char separator = 0;
+						if (!(extent >> width >> separator >> height) || separator != 'x' || extent.peek() != std::char_traits<char>::eof() || width <= 0 || height <= 0 || width > 0xffff || height > 0xffff) {
+							std::cerr << "can't parse the extent \"" << detail << "\" of script line " << number << ", expected WxH from 1x1 to 65535x65535" << std::endl;
+							return std::nullopt;
+						}
+						event = event_t{ event_e::e_resize, extent_t{ static_cast<core::u32_t>(width), static_cast<core::u32_t>(height) } };
+					}
+					else if (type == "close") event = event_t{ event_e::e_close };
+					else { std::cerr << "unknown event \"" << type << "\" of script line " << number << std::endl; return std::nullopt; }
+					if (!result.empty() && result.back().time.count() > time) { std::cerr << "script line " << number << " goes back in time" << std::endl; return std::nullopt; }
+					result.push_back({ std::chrono::milliseconds(time), event });
+				}
+				return result;
+			}
+			std::optional<std::vector<script_event_t>> load_script(const std::string& path) {
+				std::ifstream file(path);
+				if (!file) { std::cerr << "can't open script \"" << path << "\"" << std::endl; return std::nullopt; }
+				return parse_script(file);
+			}
+		}
+		std::unique_ptr<window_group_t> build_script_window_group(const window_group_script_ci_t& create_info) { return std::make_unique<priv::window_group_script_t>(create_info); }
+	}
+}
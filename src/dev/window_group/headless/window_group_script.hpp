@@ -0,0 +1,25 @@
+#pragma once
+
+#include "./../../../../inc/dev/window_group/window_group_script.hpp"
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			// replays window_group_script_ci_t::events, a script that doesn't close is closed a second after its last event
+			class window_group_script_t : public window_group_t {
+			public:
+				window_group_script_t(const window_group_script_ci_t& create_info);
+				virtual ~window_group_script_t();
+				virtual std::queue<event_t>& update();
+				virtual void kill_active_priv();
+				virtual std::optional<extent_t> headless() const;
+				virtual time_point_t now() const;
+			private:
+				window_group_script_ci_t m_ci;
+				core::ull_t m_next = 0; // the first event not sent yet
+				time_point_t m_start;
+				time_point_t m_now;
+			};
+		}
+	}
+}
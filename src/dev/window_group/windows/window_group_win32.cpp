@@ -1,4 +1,5 @@
 #include "./window_group_win32.hpp"
+#include "./../../../../inc/core/trace.hpp"
 
 #include <iostream>
 
@@ -18,6 +19,12 @@ namespace cw {
 				case VK_SPACE: return key_e::e_space;
 				case 'R': return key_e::e_r;
 				case 'F': return key_e::e_f;
+				case 'I': return key_e::e_i;
+				case 'J': return key_e::e_j;
+				case 'K': return key_e::e_k;
+				case 'L': return key_e::e_l;
+				case 'Z': return key_e::e_z;
+				case 'X': return key_e::e_x;
 				}
 				return key_e::e_null;
 			}
@@ -31,6 +38,7 @@ namespace cw {
 				global_clean();
 			}
 			std::queue<event_t>& window_group_win32_t::update() {
+				CW_TRACE_ZONE("window_group_t::update");
 				while (!window_group_t::m_event_queue.empty()) { window_group_t::m_event_queue.pop(); }
 				MSG message;
 				while (PeekMessageW(&message, m_hwnd, 0, 0, PM_REMOVE)) {
@@ -0,0 +1,19 @@
+#include "./../../../../inc/dev/window_group/priv/platform_support_xcb.hpp"
+#include "./window_group_xcb.hpp"
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			xcb_connection_t* get_xcb_connection(window_group_t* group) {
+				window_group_xcb_t* native = dynamic_cast<window_group_xcb_t*>(group);
+				assert(native != nullptr);
+				return native->get_connection();
+			}
+			xcb_window_t get_xcb_window(window_group_t* group) {
+				window_group_xcb_t* native = dynamic_cast<window_group_xcb_t*>(group);
+				assert(native != nullptr);
+				return native->get_window();
+			}
+		}
+	}
+}
@@ -0,0 +1,189 @@
+#include "./window_group_xcb.hpp"
+#include "./../headless/window_group_headless.hpp"
+#include "./../../../../inc/core/trace.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			// window titles are utf-8 for the window managers
+			decltype(auto) to_utf8(std::wstring const& text) {
+				std::string result;
+				for (auto iter : text) {
+					auto code = static_cast<std::uint32_t>(iter);
+					if (code < 0x80) result.push_back(static_cast<char>(code));
+					else if (code < 0x800) {
+						result.push_back(static_cast<char>(0xc0 | (code >> 6)));
+						result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+					}
+					else if (code < 0x10000) {
+						result.push_back(static_cast<char>(0xe0 | (code >> 12)));
+						result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+						result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+					}
+					else {
+						result.push_back(static_cast<char>(0xf0 | (code >> 18)));
+						result.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+						result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+						result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+					}
+				}
+				return result;
+			}
+			decltype(auto) find_screen(xcb_connection_t* connection, int screen_index) {
+				auto iter = xcb_setup_roots_iterator(xcb_get_setup(connection));
+				for (; iter.rem && screen_index > 0; --screen_index) xcb_screen_next(&iter);
+				return iter.data;
+			}
+
+			window_group_xcb_t::window_group_xcb_t(const window_group_ci_t& create_info, xcb_connection_t* connection, int screen_index) : m_connection(connection) {
+				assert(m_connection != nullptr && !xcb_connection_has_error(m_connection));
+				auto screen = find_screen(m_connection, screen_index);
+				assert(screen != nullptr);
+				m_window = xcb_generate_id(m_connection);
+				std::uint32_t values[] = { screen->black_pixel, XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_STRUCTURE_NOTIFY };
+				xcb_create_window(m_connection, XCB_COPY_FROM_PARENT, m_window, screen->root,
+					static_cast<std::int16_t>(create_info.m_rect.m_offset.x()), static_cast<std::int16_t>(create_info.m_rect.m_offset.y()),
+					static_cast<std::uint16_t>(create_info.m_rect.m_extent.width()), static_cast<std::uint16_t>(create_info.m_rect.m_extent.height()),
+					0, XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, values);
+				// the window manager sends WM_DELETE_WINDOW instead of killing the connection when the window is closed
+				m_wm_protocols = intern_atom("WM_PROTOCOLS");
+				m_wm_delete_window = intern_atom("WM_DELETE_WINDOW");
+				xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_window, m_wm_protocols, XCB_ATOM_ATOM, 32, 1, &m_wm_delete_window);
+				auto title = to_utf8(create_info.m_title);
+				xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, static_cast<std::uint32_t>(title.size()), title.data());
+				xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_window, intern_atom("_NET_WM_NAME"), intern_atom("UTF8_STRING"), 8, static_cast<std::uint32_t>(title.size()), title.data());
+				load_keyboard_mapping();
+				m_data.last_offset = create_info.m_rect.m_offset;
+				m_data.last_extent = create_info.m_rect.m_extent;
+				xcb_map_window(m_connection, m_window);
+				xcb_flush(m_connection);
+				window_group_t::m_is_active = true;
+			}
+			window_group_xcb_t::~window_group_xcb_t() {
+				if (!xcb_connection_has_error(m_connection)) xcb_destroy_window(m_connection, m_window);
+				xcb_disconnect(m_connection);
+			}
+			std::queue<event_t>& window_group_xcb_t::update() {
+				CW_TRACE_ZONE("window_group_t::update");
+				while (!window_group_t::m_event_queue.empty()) { window_group_t::m_event_queue.pop(); }
+				while (auto event = xcb_poll_for_event(m_connection)) {
+					handle(event);
+					std::free(event);
+				}
+				// the x server went away, nothing can be shown anymore
+				if (m_is_active && xcb_connection_has_error(m_connection)) {
+					std::cerr << "lost the connection to the X server" << std::endl;
+					window_group_t::m_event_queue.push(event_t{ event_e::e_close });
+					window_group_t::m_is_active = false;
+				}
+				return window_group_t::m_event_queue;
+			}
+			void window_group_xcb_t::kill_active_priv() {
+				xcb_unmap_window(m_connection, m_window);
+				xcb_flush(m_connection);
+			}
+			xcb_connection_t* window_group_xcb_t::get_connection() const { return m_connection; }
+			xcb_window_t window_group_xcb_t::get_window() const { return m_window; }
+
+			void window_group_xcb_t::load_keyboard_mapping() {
+				auto setup = xcb_get_setup(m_connection);
+				auto reply = xcb_get_keyboard_mapping_reply(m_connection, xcb_get_keyboard_mapping(m_connection, setup->min_keycode, static_cast<std::uint8_t>(setup->max_keycode - setup->min_keycode + 1)), nullptr);
+				if (reply == nullptr) { std::cerr << "can't get the keyboard mapping" << std::endl; return; }
+				auto keysyms = xcb_get_keyboard_mapping_keysyms(reply);
+				m_keyboard.min_keycode = setup->min_keycode;
+				m_keyboard.keysyms_per_keycode = reply->keysyms_per_keycode;
+				m_keyboard.keysyms.assign(keysyms, keysyms + xcb_get_keyboard_mapping_keysyms_length(reply));
+				std::free(reply);
+			}
+			// by the first keysym of the key, as the virtual keys of win32 ignore shift
+			key_e window_group_xcb_t::to_key(xcb_keycode_t keycode) const {
+				if (keycode < m_keyboard.min_keycode || m_keyboard.keysyms_per_keycode == 0) return key_e::e_null;
+				auto index = (keycode - m_keyboard.min_keycode) * m_keyboard.keysyms_per_keycode;
+				if (index >= m_keyboard.keysyms.size()) return key_e::e_null;
+				switch (m_keyboard.keysyms[index]) {
+				case 'w': case 'W': return key_e::e_w;
+				case 'a': case 'A': return key_e::e_a;
+				case 's': case 'S': return key_e::e_s;
+				case 'd': case 'D': return key_e::e_d;
+				case 0xff51: return key_e::e_left; // XK_Left
+				case 0xff53: return key_e::e_right; // XK_Right
+				case 0xff52: return key_e::e_up; // XK_Up
+				case 0xff54: return key_e::e_down; // XK_Down
+				case ' ': return key_e::e_space;
+				case 'r': case 'R': return key_e::e_r;
+				case 'f': case 'F': return key_e::e_f;
+				case 'i': case 'I': return key_e::e_i;
+				case 'j': case 'J': return key_e::e_j;
+				case 'k': case 'K': return key_e::e_k;
+				case 'l': case 'L': return key_e::e_l;
+				case 'z': case 'Z': return key_e::e_z;
+				case 'x': case 'X': return key_e::e_x;
+				}
+				return key_e::e_null;
+			}
+			xcb_atom_t window_group_xcb_t::intern_atom(const char* name) const {
+				auto reply = xcb_intern_atom_reply(m_connection, xcb_intern_atom(m_connection, 0, static_cast<std::uint16_t>(std::strlen(name)), name), nullptr);
+				if (reply == nullptr) { std::cerr << "can't intern atom " << name << std::endl; return XCB_ATOM_NONE; }
+				auto result = reply->atom;
+				std::free(reply);
+				return result;
+			}
+			void window_group_xcb_t::handle(const xcb_generic_event_t* event) {
+				// the top bit marks events sent by other clients
+				switch (event->response_type & 0x7f) {
+				case XCB_CLIENT_MESSAGE: {
+					auto message = reinterpret_cast<const xcb_client_message_event_t*>(event);
+					if (message->type == m_wm_protocols && message->data.data32[0] == m_wm_delete_window) {
+						window_group_t::m_event_queue.push(event_t{ event_e::e_close });
+						window_group_t::m_is_active = false;
+					}
+				}break;
+				case XCB_DESTROY_NOTIFY: {
+					window_group_t::m_event_queue.push(event_t{ event_e::e_close });
+					window_group_t::m_is_active = false;
+				}break;
+				case XCB_CONFIGURE_NOTIFY: {
+					auto configure = reinterpret_cast<const xcb_configure_notify_event_t*>(event);
+					// a reparenting window manager sends the position relative to its frame, only the synthetic ones are on the root
+					if (event->response_type & 0x80) {
+						offset_t offset = { configure->x, configure->y };
+						if (m_data.last_offset != offset) {
+							m_data.last_offset = offset;
+							window_group_t::m_event_queue.push(event_t{ event_e::e_move, offset });
+						}
+					}
+					extent_t extent = { configure->width, configure->height };
+					if (m_data.last_extent != extent) {
+						m_data.last_extent = extent;
+						window_group_t::m_event_queue.push(event_t{ event_e::e_resize, extent });
+					}
+				}break;
+				case XCB_KEY_PRESS: {
+					window_group_t::m_event_queue.push(event_t{ event_e::e_keydown, to_key(reinterpret_cast<const xcb_key_press_event_t*>(event)->detail) });
+				}break;
+				case XCB_KEY_RELEASE: {
+					window_group_t::m_event_queue.push(event_t{ event_e::e_keyup, to_key(reinterpret_cast<const xcb_key_release_event_t*>(event)->detail) });
+				}break;
+				case XCB_MAPPING_NOTIFY: {
+					if (reinterpret_cast<const xcb_mapping_notify_event_t*>(event)->request == XCB_MAPPING_KEYBOARD) load_keyboard_mapping();
+				}break;
+				}
+			}
+		}
+		// without a display, e.g. on a server, nothing is shown and the renderer draws offscreen
+		std::unique_ptr<window_group_t> build_window_group(const window_group_ci_t& create_info) {
+			int screen_index = 0;
+			auto connection = xcb_connect(nullptr, &screen_index);
+			if (xcb_connection_has_error(connection)) {
+				xcb_disconnect(connection);
+				std::cerr << "can't connect to the X server, running headless" << std::endl;
+				return std::make_unique<priv::window_group_headless_t>(create_info);
+			}
+			return std::make_unique<priv::window_group_xcb_t>(create_info, connection, screen_index);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "./../../../../inc/dev/window_group/window_group.hpp"
+
+#include <xcb/xcb.h>
+#include <cassert>
+#include <vector>
+
+namespace cw {
+	namespace dev {
+		namespace priv {
+			class window_group_xcb_t : public window_group_t {
+			public:
+				// takes the connection, see build_window_group()
+				window_group_xcb_t(const window_group_ci_t& create_info, xcb_connection_t* connection, int screen_index);
+				virtual ~window_group_xcb_t();
+				// never blocks, drains the events already received
+				virtual std::queue<event_t>& update();
+				virtual void kill_active_priv();
+				xcb_connection_t* get_connection() const;
+				xcb_window_t get_window() const;
+			private:
+				void load_keyboard_mapping();
+				key_e to_key(xcb_keycode_t keycode) const;
+				xcb_atom_t intern_atom(const char* name) const;
+				void handle(const xcb_generic_event_t* event);
+			private:
+				xcb_connection_t* m_connection;
+				xcb_window_t m_window;
+				xcb_atom_t m_wm_protocols;
+				xcb_atom_t m_wm_delete_window;
+
+				struct {
+					xcb_keycode_t min_keycode = 0;
+					core::ull_t keysyms_per_keycode = 0;
+					std::vector<xcb_keysym_t> keysyms;
+				}m_keyboard;
+				struct {
+					offset_t last_offset;
+					extent_t last_extent;
+				}m_data;
+			};
+		}
+	}
+}
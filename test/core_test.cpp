@@ -0,0 +1,264 @@
+#include "./../inc/core/vec.hpp"
+#include "./../inc/core/strided_view.hpp"
+#include "./../inc/core/memory.hpp"
+#include "./../inc/core/inplace_function.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#if defined(CW_SIMD_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+	checks of the core kernels against plain loops, cmake builds this file once per instruction set (see cw_add_core_test)
+	so every simd path is compared with the scalar one, the values are small integers and halves so float results are exact
+	the exit code is 1 when a check fails, 77 when the cpu lacks the instruction set the binary was built for
+*/
+
+using namespace cw;
+
+static core::ull_t failed = 0;
+
+#define CW_CHECK(expression) do { if (!(expression)) { ++failed; std::cerr << __FILE__ << ":" << __LINE__ << " : check failed : " #expression << std::endl; } } while (false)
+
+static const char* simd_name() {
+#if defined(CW_SIMD_AVX2)
+	return "avx2";
+#elif defined(CW_SIMD_SSE41)
+	return "sse4.1";
+#elif defined(CW_SIMD_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+static bool is_cpu_supported() {
+#if defined(CW_SIMD_AVX2) && defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(CW_SIMD_AVX2) && defined(__GNUC__)
+	return __builtin_cpu_supports("avx2");
+#elif defined(CW_SIMD_SSE41) && defined(__GNUC__)
+	return __builtin_cpu_supports("sse4.1");
+#else
+	return true;
+#endif
+}
+
+// i-th test value of a component, negative and positive
+template<typename _type> static _type value_of(core::ull_t i) { return static_cast<_type>(static_cast<int>(i * 7 % 23) - 11) / static_cast<_type>(std::is_floating_point_v<_type> ? 2 : 1); }
+
+template<typename _type, core::ull_t _size>
+static void check_vec() {
+	using vec_t = core::priv::inner_vec_t<_type, _size>;
+	// every count up to a few steps of the widest register, so both the kernels and their tails run
+	for (core::ull_t count = 0; count < 40; ++count) {
+		std::vector<vec_t> a(count), b(count), result(count);
+		for (core::ull_t i = 0; i < count; ++i) {
+			for (core::ull_t j = 0; j < _size; ++j) {
+				a[i][j] = value_of<_type>(i * _size + j);
+				b[i][j] = value_of<_type>(i * _size + j + 5);
+			}
+			// some vectors equal and some less in every component, so both comparisons see true and false
+			if (i % 3 == 0) b[i] = a[i];
+			if (i % 4 == 1) b[i] = a[i] + static_cast<_type>(1);
+		}
+
+		core::func::add(a.data(), b.data(), result.data(), count);
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(result[i] == a[i] + b[i]);
+
+		vec_t scale, offset;
+		for (core::ull_t j = 0; j < _size; ++j) {
+			scale[j] = static_cast<_type>(j + 2);
+			offset[j] = value_of<_type>(j + 3);
+		}
+		core::func::transform(a.data(), result.data(), count, scale, offset);
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(result[i] == a[i] * scale + offset);
+
+		std::unique_ptr<bool[]> flags(new bool[count + 1]);
+		core::func::less(a.data(), b.data(), flags.get(), count);
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(flags[i] == (a[i] < b[i]));
+		core::func::equal(a.data(), b.data(), flags.get(), count);
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(flags[i] == (a[i] == b[i]));
+	}
+}
+
+static void check_matrix_transform() {
+	using vec_t = core::vec4_t<float>;
+	vec_t columns[4];
+	for (core::ull_t c = 0; c < 4; ++c) for (core::ull_t r = 0; r < 4; ++r) columns[c][r] = value_of<float>(c * 4 + r);
+	std::vector<vec_t> source(13), result(13);
+	for (core::ull_t i = 0; i < source.size(); ++i) for (core::ull_t j = 0; j < 4; ++j) source[i][j] = value_of<float>(i * 4 + j + 1);
+	core::func::transform(columns, source.data(), result.data(), source.size());
+	for (core::ull_t i = 0; i < source.size(); ++i) {
+		for (core::ull_t r = 0; r < 4; ++r) {
+			float expect = 0.0f;
+			for (core::ull_t c = 0; c < 4; ++c) expect += columns[c][r] * source[i][c];
+			CW_CHECK(result[i][r] == expect);
+		}
+	}
+}
+
+// records of stride bytes, the checked field at offset, the other bytes have to stay untouched
+template<typename _type>
+static void check_strided_view(core::ull_t stride, core::ull_t offset) {
+	for (core::ull_t count = 0; count < 40; ++count) {
+		std::vector<core::byte_t> records(count * stride + 8, 0xcd);
+		core::strided_view_t<_type> view(core::memory_view_t(count * stride, records.data()), stride, offset);
+		CW_CHECK(view.size() == count);
+		std::vector<_type> values(count), back(count);
+		for (core::ull_t i = 0; i < count; ++i) values[i] = value_of<_type>(i);
+
+		// a record is untouched outside of its field
+		auto is_untouched = [&](core::ull_t i) {
+			for (core::ull_t k = 0; k < stride; ++k) if ((k < offset || k >= offset + sizeof(_type)) && records[i * stride + k] != 0xcd) return false;
+			return true;
+		};
+		auto tail_untouched = [&]() {
+			for (core::ull_t k = count * stride; k < records.size(); ++k) if (records[k] != 0xcd) return false;
+			return true;
+		};
+
+		core::func::scatter(values.data(), view);
+		for (core::ull_t i = 0; i < count; ++i) {
+			_type field;
+			std::memcpy(&field, records.data() + i * stride + offset, sizeof(_type));
+			CW_CHECK(field == values[i]);
+			CW_CHECK(is_untouched(i));
+		}
+		CW_CHECK(tail_untouched());
+
+		core::func::gather(view, back.data());
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(back[i] == values[i]);
+
+		auto value = value_of<_type>(count + 3);
+		core::func::fill(view, value);
+		for (core::ull_t i = 0; i < count; ++i) {
+			CW_CHECK(view[i] == value);
+			CW_CHECK(is_untouched(i));
+		}
+		CW_CHECK(tail_untouched());
+
+		// strided to strided goes through the scalar loop, strided from contiguous through scatter
+		std::vector<core::byte_t> others(count * stride, 0);
+		core::strided_view_t<_type> other(core::memory_view_t(count * stride, others.data()), stride, offset);
+		core::func::copy(view, other);
+		for (core::ull_t i = 0; i < other.size(); ++i) CW_CHECK(other[i] == value);
+		core::func::copy(core::strided_view_t<_type>(core::memory_view_t(values)), view);
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(view[i] == values[i]);
+
+		core::func::iota(view, _type(1));
+		for (core::ull_t i = 0; i < count; ++i) CW_CHECK(view[i] == static_cast<_type>(i + 1));
+	}
+}
+
+static void check_inplace_function() {
+	// counts the live copies of the callable
+	struct counted_t {
+		int* live;
+		int add;
+		counted_t(int* live, int add) : live(live), add(add) { ++*live; }
+		counted_t(counted_t const& other) : live(other.live), add(other.add) { ++*live; }
+		counted_t(counted_t&& other) noexcept : live(other.live), add(other.add) { ++*live; }
+		~counted_t() { --*live; }
+		int operator()(int value) const { return value + add; }
+	};
+	int live = 0;
+	{
+		core::inplace_function_t<int(int), 32> func = counted_t(&live, 3);
+		CW_CHECK(live == 1);
+		CW_CHECK(static_cast<bool>(func));
+		CW_CHECK(func(4) == 7);
+		auto copy = func;
+		CW_CHECK(live == 2 && copy(1) == 4);
+		auto moved = std::move(copy);
+		CW_CHECK(moved(2) == 5);
+		core::inplace_function_t<int(int), 32> empty;
+		CW_CHECK(!empty);
+		empty = moved;
+		CW_CHECK(empty(0) == 3);
+		func = nullptr;
+		CW_CHECK(!func);
+		func = [](int value) { return value * 2; };
+		CW_CHECK(func(4) == 8);
+	}
+	CW_CHECK(live == 0);
+}
+
+template<typename _memory>
+static void check_memory(_memory memory) {
+	memory.rebyte(16);
+	CW_CHECK(memory.byte() == 16 && memory.capacity() >= 16);
+	for (core::ull_t i = 0; i < 16; ++i) CW_CHECK(static_cast<const core::byte_t*>(memory.data())[i] == 0);
+	for (core::ull_t i = 0; i < 16; ++i) static_cast<core::byte_t*>(memory.data())[i] = static_cast<core::byte_t>(i + 1);
+	// growing keeps the bytes and zeroes the new ones
+	memory.rebyte(48, false);
+	CW_CHECK(memory.byte() == 48);
+	for (core::ull_t i = 0; i < 16; ++i) CW_CHECK(static_cast<const core::byte_t*>(memory.data())[i] == i + 1);
+	for (core::ull_t i = 16; i < 48; ++i) CW_CHECK(static_cast<const core::byte_t*>(memory.data())[i] == 0);
+	CW_CHECK(reinterpret_cast<std::uintptr_t>(memory.data()) % memory.alignment() == 0);
+	// shrinking keeps the capacity, growing back within it doesn't move the data
+	auto data = memory.data();
+	auto capacity = memory.capacity();
+	memory.rebyte(8, false);
+	CW_CHECK(memory.byte() == 8 && memory.capacity() == capacity);
+	memory.rebyte_uninitialized(40);
+	CW_CHECK(memory.data() == data && memory.byte() == 40);
+	// a clean rebyte drops the old bytes
+	memory.rebyte(24);
+	for (core::ull_t i = 0; i < 24; ++i) CW_CHECK(static_cast<const core::byte_t*>(memory.data())[i] == 0);
+	std::uint32_t words[3] = { 1, 2, 3 };
+	memory.reset(sizeof(words), words);
+	CW_CHECK(memory.byte() == sizeof(words) && std::memcmp(memory.data(), words, sizeof(words)) == 0);
+	auto copy = memory;
+	CW_CHECK(copy.byte() == memory.byte() && copy.data() != memory.data() && std::memcmp(copy.data(), words, sizeof(words)) == 0);
+	auto moved = std::move(copy);
+	CW_CHECK(moved.byte() == sizeof(words) && copy.byte() == 0 && copy.data() == nullptr);
+}
+
+static void check_memories() {
+	check_memory(core::memory_t());
+	check_memory(core::aligned_memory_t(0, nullptr, 64));
+	core::arena_t arena(1024);
+	check_memory(core::arena_memory_t(0, nullptr, 16, core::arena_allocator_t{ &arena }));
+	// the latest arena allocation grows in place
+	{
+		arena.reset();
+		core::arena_memory_t memory(32, nullptr, 16, core::arena_allocator_t{ &arena });
+		auto data = memory.data();
+		memory.rebyte(64, false);
+		CW_CHECK(memory.data() == data && arena.used() == 64);
+	}
+	core::pool_t pool(64);
+	check_memory(core::pool_memory_t(0, nullptr, 16, core::pool_allocator_t{ &pool }));
+}
+
+int main() {
+	if (!is_cpu_supported()) {
+		std::cout << "this cpu has no " << simd_name() << ", skipped" << std::endl;
+		return 77;
+	}
+	check_vec<float, 2>();
+	check_vec<float, 3>();
+	check_vec<float, 4>();
+	check_vec<std::int32_t, 2>();
+	check_vec<std::int32_t, 3>();
+	check_vec<std::int32_t, 4>();
+	check_vec<double, 3>();
+	check_matrix_transform();
+	check_strided_view<std::uint32_t>(8, 0);
+	check_strided_view<std::uint32_t>(8, 4);
+	check_strided_view<float>(8, 4);
+	check_strided_view<std::uint32_t>(12, 4);
+	check_strided_view<std::uint16_t>(6, 2);
+	check_strided_view<std::uint64_t>(24, 8);
+	check_inplace_function();
+	check_memories();
+	std::cout << simd_name() << " : " << failed << " checks failed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include "./../inc/dev/window_group/window_group_script.hpp"
+
+#include <iostream>
+#include <sstream>
+
+/*
+	checks of dev::func::parse_script, the format of window_group_script.hpp
+	the exit code is 1 when a check fails
+*/
+
+using namespace cw;
+
+static core::ull_t failed = 0;
+
+#define CW_CHECK(expression) do { if (!(expression)) { ++failed; std::cerr << __FILE__ << ":" << __LINE__ << " : check failed : " #expression << std::endl; } } while (false)
+
+static decltype(auto) parse(std::string const& text) {
+	std::istringstream is(text);
+	return dev::func::parse_script(is);
+}
+
+int main() {
+	{
+		auto events = parse("# comment\n\n0 keydown SPACE\n500 keyup UP\n1200 resize 640x480\n  \n5000 close\n");
+		CW_CHECK(events.has_value() && events.value().size() == 4);
+		if (events.has_value() && events.value().size() == 4) {
+			auto const& list = events.value();
+			CW_CHECK(list[0].time.count() == 0 && list[0].event.etype == dev::event_e::e_keydown && std::get<dev::key_e>(list[0].event.detail) == dev::key_e::e_space);
+			CW_CHECK(list[1].time.count() == 500 && list[1].event.etype == dev::event_e::e_keyup && std::get<dev::key_e>(list[1].event.detail) == dev::key_e::e_up);
+			CW_CHECK(list[2].time.count() == 1200 && list[2].event.etype == dev::event_e::e_resize);
+			CW_CHECK(std::get<dev::extent_t>(list[2].event.detail).width() == 640 && std::get<dev::extent_t>(list[2].event.detail).height() == 480);
+			CW_CHECK(list[3].time.count() == 5000 && list[3].event.etype == dev::event_e::e_close);
+		}
+	}
+	// an empty script is valid, the group closes a second later
+	CW_CHECK(parse("").has_value() && parse("").value().empty());
+	// every malformed line fails the whole script
+	for (auto text : {
+		"keydown SPACE\n",			// no time
+		"0 keydown NOTAKEY\n",		// unknown key
+		"0 jump\n",					// unknown event
+		"100 close\n50 close\n",	// back in time
+		"0 resize 640\n",			// no height
+		"0 resize 0x480\n",			// empty extent
+		"0 resize 640x-1\n",
+		"0 resize 70000x480\n",		// above 65535
+		"0 resize 640x480px\n",		// trailing characters
+	}) {
+		if (parse(text).has_value()) {
+			++failed;
+			std::cerr << "script \"" << text << "\" was accepted" << std::endl;
+		}
+	}
+	std::cout << failed << " checks failed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
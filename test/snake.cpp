@@ -1,8 +1,16 @@
 #include "./../inc/graphic/vulkan/vulkan.hpp"
 #include "./../inc/dev/window_group/window_group.hpp"
 #include "./../inc/dev/window_group/platform_support.hpp"
+#include "./../inc/dev/window_group/window_group_script.hpp"
 #include "./../inc/core/memory.hpp"
+#include "./../inc/core/frame_arena.hpp"
+#include "./../inc/core/strided_view.hpp"
 #include "./../inc/core/vec2.hpp"
+#include "./../inc/core/thread_pool.hpp"
+#include "./../inc/core/trace.hpp"
+#define CW_ALLOC_TRACKER_IMPLEMENTATION
+#include "./../inc/core/alloc_tracker.hpp"
+#include "./snake_batch.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -34,11 +42,25 @@ struct snake_game_ci_t {
 	core::ull_t win_score = 30;
 	difficulty_t difficulty = difficulty_t::e_easy;
 	bool console_game = true;
+	std::uint32_t profile_interval = 0; // log gpu timings every profile_interval frames, 0 turns profiling off
+	vku::present_policy_e present_policy = vku::present_policy_e::e_null; // e_null follows vsync
+	std::uint32_t record_threads = 0; // workers recording the render funcs into secondary command buffers, 0 records them on the calling thread
+	std::uint32_t alloc_report_interval = 0; // log the heap allocations of a frame every alloc_report_interval frames, 0 turns it off
+	std::uint32_t alloc_check_warmup = 0; // every frame after the first alloc_check_warmup must not allocate, 0 turns the check off
+	std::optional<dev::window_group_script_ci_t> script; // replay these events without a window instead of reading the keyboard
+	std::string capture_path; // write the first drawn frame there as a binary ppm, empty turns it off
 	decltype(auto) set_extent(core::extent2_t<core::ull_t> extent) { this->extent = extent; return *this; }
 	decltype(auto) set_window_rate(core::ull_t window_rate) { this->window_rate = window_rate; return *this; }
 	decltype(auto) set_win_score(core::ull_t win_score) { this->win_score = win_score; return *this; }
 	decltype(auto) set_difficulty(difficulty_t difficulty) { this->difficulty = difficulty; return *this; }
 	decltype(auto) set_console_game(bool console_game) { this->console_game = console_game; return *this; }
+	decltype(auto) set_profile_interval(std::uint32_t profile_interval) { this->profile_interval = profile_interval; return *this; }
+	decltype(auto) set_present_policy(vku::present_policy_e present_policy) { this->present_policy = present_policy; return *this; }
+	decltype(auto) set_record_threads(std::uint32_t record_threads) { this->record_threads = record_threads; return *this; }
+	decltype(auto) set_alloc_report_interval(std::uint32_t alloc_report_interval) { this->alloc_report_interval = alloc_report_interval; return *this; }
+	decltype(auto) set_alloc_check_warmup(std::uint32_t alloc_check_warmup) { this->alloc_check_warmup = alloc_check_warmup; return *this; }
+	decltype(auto) set_script(dev::window_group_script_ci_t const& script) { this->script = script; return *this; }
+	decltype(auto) set_capture_path(std::string const& capture_path) { this->capture_path = capture_path; return *this; }
 };
 
 class snake_game_t {
@@ -91,14 +113,74 @@ private:
 		}
 		return "null"s;
 	}
+	static decltype(auto) to_name(cell_e cell) {
+		switch (cell) {
+		case cell_e::e_empty:return std::string("empty");
+		case cell_e::e_wall :return std::string("wall");
+		case cell_e::e_food :return std::string("food");
+		case cell_e::e_head :return std::string("head");
+		case cell_e::e_body :return std::string("body");
+		case cell_e::e_tail :return std::string("tail");
+		case cell_e::e_null :return std::string("null");
+		}
+		return std::string("");
+	}
+
+	struct texture_t {
+		texture_t(const char* path) {
+			data = stbi_load(path, &width, &height, &channel, STBI_rgb_alpha);
+			if (!data) std::cerr << "can't load texture \"" << path << "\"" << std::endl;
+		}
+		texture_t(texture_t const&) = delete;
+		~texture_t() {
+			stbi_image_free(data);
+		}
+		// always rgba, channel is the channel count of the source file
+		decltype(auto) byte()const noexcept { return width * height * STBI_rgb_alpha * sizeof(core::u8_t); }
+
+		int width = 0, height = 0, channel = 0;
+		core::u8_t* data = nullptr;
+	};
+	// decode every cell texture in parallel, the result keeps the order of cell_e
+	static decltype(auto) decode_textures(std::string const& directory) {
+		std::vector<std::unique_ptr<texture_t>> textures((std::uint32_t)cell_e::e_null);
+		core::thread_pool_t pool(std::min<core::ull_t>(textures.size(), std::thread::hardware_concurrency()));
+		pool.parallel_for(textures.size(), [&](core::ull_t i) {
+			auto path = directory + to_name(static_cast<cell_e>(i)) + ".png";
+			textures[i] = std::make_unique<texture_t>(path.c_str());
+		});
+		return textures;
+	}
+public:
+	// offline step : decode the cell textures once and write them as a texture bundle
+	static decltype(auto) pack_textures(std::string const& directory, std::string const& path, bool compress) {
+		auto textures = decode_textures(directory);
+		std::vector<core::memory_view_t> layers;
+		for (const auto& iter : textures) {
+			if (!iter->data || iter->byte() != textures[0]->byte()) return false;
+			layers.push_back(core::memory_view_t(iter->byte(), iter->data));
+		}
+		return vku::func::pack_texture_bundle(path, compress ? vk::Format::eBc3UnormBlock : vk::Format::eR8G8B8A8Unorm, textures[0]->width, textures[0]->height, layers);
+	}
+private:
 
 	bool m_console = true;
+	std::uint32_t m_alloc_report_interval = 0;
+	std::uint32_t m_alloc_check_warmup = 0;
+	bool m_script = false;
 	std::unique_ptr<dev::window_group_t> m_window_group;
+	core::frame_arena_t m_frame_arena{ 1 << 20 }; // transient data of a frame, begins again in run()
 
 	struct {
 		//difficulty_t difficulty = difficulty_t::e_normal;
 		std::chrono::milliseconds difficulty_time;
-		std::chrono::high_resolution_clock::time_point last_time = std::chrono::high_resolution_clock::now();
+		dev::time_point_t last_time; // of the last step, on the clock of the window group
+		// from a key turning the snake to the step that moves it that way
+		struct {
+			std::optional<dev::time_point_t> input_time;
+			core::ull_t count = 0;
+			std::chrono::nanoseconds total{ 0 }, max{ 0 };
+		}latency;
 
 		direction_e current_direction = direction_e::e_null;
 		game_state_e state = game_state_e::e_null;
@@ -108,6 +190,7 @@ private:
 
 		core::ull_t win_score = 30;
 		std::vector<std::vector<cell_e>> map;
+		std::vector<core::offset2_t<core::ull_t>> changed; // cells written since the renderer last took them
 		std::optional<core::offset2_t<core::ull_t>> food;
 		std::deque<core::offset2_t<core::ull_t>> snake;
 
@@ -127,11 +210,15 @@ private:
 			state = game_state_e::e_pause;
 		}
 		decltype(auto) clean() {}
+		decltype(auto) set_cell(core::offset2_t<core::ull_t> const& offset, cell_e cell) {
+			map[offset.y()][offset.x()] = cell;
+			changed.push_back(offset);
+		}
 		decltype(auto) reset() {
 			state = game_state_e::e_pause;
 			current_direction = direction_e::e_null;
 			if (food.has_value()) snake.push_back(food.value());
-			for (auto iter : snake) map[iter.y()][iter.x()] = cell_e::e_empty;
+			for (auto iter : snake) set_cell(iter, cell_e::e_empty);
 			snake.clear();
 			food = std::nullopt;
 		}
@@ -142,6 +229,7 @@ private:
 			return result;
 		}
 		decltype(auto) game_logic(direction_e direction) {
+			CW_TRACE_ZONE("logic::game_logic");
 			if (!food.has_value()) food = random_unique();
 			if (snake.empty()) snake.push_back(random_unique());
 
@@ -154,16 +242,16 @@ private:
 			}
 			if (next != food.value() && next != snake.front() && map[next.y()][next.x()] != cell_e::e_empty) { state = game_state_e::e_failed; return; }
 
-			map[food.value().y()][food.value().x()] = cell_e::e_food;
-			map[snake.front().y()][snake.front().x()] = cell_e::e_body;
-			map[snake.back().y()][snake.back().x()] = cell_e::e_empty;
+			set_cell(food.value(), cell_e::e_food);
+			set_cell(snake.front(), cell_e::e_body);
+			set_cell(snake.back(), cell_e::e_empty);
 			snake.push_front(next);
 
 			if (next != food.value()) snake.pop_back();
 			else food = std::nullopt;
 
-			map[snake.back().y()][snake.back().x()] = cell_e::e_tail;
-			map[snake.front().y()][snake.front().x()] = cell_e::e_head;
+			set_cell(snake.back(), cell_e::e_tail);
+			set_cell(snake.front(), cell_e::e_head);
 
 			if (snake.size() > win_score) { state = game_state_e::e_win; return; }
 		}
@@ -189,9 +277,13 @@ private:
 			return current_direction;
 		}
 		decltype(auto) console_display(bool clean = true) const {
+#ifdef CW_CONFIG_USE_PLATFORM_WINDOWS
 			if (clean) std::system("cls");
+#else
+			if (clean) std::system("clear");
+#endif
 			std::cout << "[ vulkan snake game in console ]" << std::endl;
-			std::cout << "how to use : \n\t" << "[ space ] -> begin/continue/pause\n\t" << "[ r ] -> reset\n\t" << "[ wasd ] or [ arrow ] -> move snake\n\t" << "[ f ] -> move fast" << std::endl;
+			std::cout << "how to use : \n\t" << "[ space ] -> begin/continue/pause\n\t" << "[ r ] -> reset\n\t" << "[ wasd ] or [ arrow ] -> move snake\n\t" << "[ f ] -> move fast\n\t" << "[ ijkl ] / [ z x ] -> pan / zoom the camera" << std::endl;
 			std::cout << "direction/state : [ " << to_string(current_direction) << "/" << to_string(state) << " ]" << std::endl;
 			std::cout << "win_score/score : [ " << win_score << "/" << snake.size() - 1 << " ]" << std::endl;
 			for (const auto& y : map) {
@@ -199,27 +291,44 @@ private:
 				std::cout << std::endl;
 			}
 		}
-		decltype(auto) update(std::queue<dev::event_t> queue) {
+		decltype(auto) update(core::frame_vector_t<dev::event_t> const& events, dev::time_point_t current_time) {
+			CW_TRACE_ZONE("logic::update");
+			CW_ALLOC_TAG(e_logic);
 			bool is_run_logic = false;
-			auto current_time = std::chrono::high_resolution_clock::now();
 			if (current_time - last_time > difficulty_time) {
 				last_time = current_time;
 				is_run_logic = true;
 			}
 
-			while (!queue.empty()) {
-				auto event = queue.front();
+			for (const auto& event : events) {
 				if (event.etype == dev::event_e::e_keydown) {
 					auto key = std::get<dev::key_e>(event.detail);
 					std::cout << dev::to_string(key) << std::endl;
 					if (key == dev::key_e::e_space && (state == game_state_e::e_continue || state == game_state_e::e_pause)) state = state == game_state_e::e_continue ? game_state_e::e_pause : game_state_e::e_continue;
 					else if (key == dev::key_e::e_r) reset();
 					else if (key == dev::key_e::e_f) is_run_logic = true;
-					else if (state == game_state_e::e_continue) current_direction = caculate_direction(key);
+					else if (state == game_state_e::e_continue) {
+						auto direction = caculate_direction(key);
+						if (direction != current_direction && !latency.input_time.has_value()) latency.input_time = current_time;
+						current_direction = direction;
+					}
+				}
+			}
+			if (state == game_state_e::e_continue && is_run_logic) {
+				game_logic(current_direction);
+				if (latency.input_time.has_value()) {
+					auto time = current_time - latency.input_time.value();
+					latency.input_time.reset();
+					++latency.count;
+					latency.total += time;
+					latency.max = (std::max)(latency.max, time);
 				}
-				queue.pop();
 			}
-			if (state == game_state_e::e_continue && is_run_logic) game_logic(current_direction);
+		}
+		decltype(auto) log_latency(std::ostream& os) const {
+			if (latency.count == 0) { os << "input to state latency : no turn was taken" << std::endl; return; }
+			os << "input to state latency : " << std::chrono::duration<double, std::milli>(latency.total).count() / latency.count << "ms average, "
+				<< std::chrono::duration<double, std::milli>(latency.max).count() << "ms max over " << latency.count << " turns" << std::endl;
 		}
 	}m_logic;
 
@@ -228,31 +337,90 @@ private:
 			glm::vec3 pos;
 			glm::vec2 uv;
 		};
-		struct mvp_t {
-			glm::mat4 model;
-			glm::mat4 view;
-			glm::mat4 proj;
-		};
+		// position, scale and color of a cell are derived in the shaders from the specialization constants
 		struct instance_t {
-			glm::vec3 pos;
-			glm::vec3 scale;
-			glm::vec4 color;
+			std::uint32_t cell; // y * width + x
 			std::uint32_t texture_index;
 		};
-		std::wstring vert_path = L"./res/shader/snake.vert.spv", frag_path = L"./res/shader/snake.frag.spv";
+		// constant_id 0 .. 6 of snake.vert, cull.comp uses 0 .. 2 and 7
+		struct specialization_t {
+			std::uint32_t grid_width;
+			std::uint32_t grid_height;
+			float cell_scale;
+			glm::vec4 palette;
+			std::uint32_t chunk_cells;
+		};
+		// push constants of snake.vert
+		struct constant_t {
+			glm::mat4 mvp; // proj * view * model
+			std::uint32_t lod;
+		};
+		std::filesystem::path vert_path = "./res/shader/snake.vert.spv", frag_path = "./res/shader/snake.frag.spv";
+		std::filesystem::path cull_path = "./res/shader/cull.comp.spv";
+		std::string texture_directory = "./res/texture/", texture_bundle_path = "./res/texture/cell.bundle";
+		std::uint32_t profile_interval = 0;
+		vku::present_policy_e present_policy = vku::present_policy_e::e_null;
+		std::uint32_t record_threads = 0;
+		std::string capture_path;
+		std::unique_ptr<core::thread_pool_t> record_pool; // outlives the window, its workers own the secondary command pools
 
 		std::vector<std::vector<cell_e>>* map = nullptr;
+		std::vector<core::offset2_t<core::ull_t>>* changed = nullptr;
+		core::frame_arena_t* arena = nullptr;
 
 		std::unique_ptr<vku::device_t> device;
 		std::unique_ptr<vku::window_t> window;
+		std::unique_ptr<vku::descriptor_allocator_t> descriptors; // sets of the draw pipeline
+		std::unique_ptr<vku::frame_descriptor_allocator_t> frame_descriptors; // the cull set of each frame slot
+		std::unique_ptr<vku::bindless_table_t> bindless; // holds the texture array when descriptor indexing is on, new textures never rebuild the pipeline
 		struct {
-			std::vector<vk::DescriptorSetLayout> descriptor_set_layouts;
+			std::vector<vk::DescriptorSetLayout> descriptor_set_layouts; // owned, empty when the bindless table is bound instead
 			vk::PipelineLayout pipeline_layout;
 			vk::Pipeline pipeline;
 
-			vk::DescriptorPool descriptor_pool;
 			std::vector<vk::DescriptorSet> descriptor_sets;
 		}pipeline;
+		// compute pre-pass : visible, non empty cells are compacted into buffer.visible and drawn indirectly
+		struct {
+			vk::DescriptorSetLayout descriptor_set_layout;
+			vk::PipelineLayout pipeline_layout;
+			vk::Pipeline pipeline;
+		}cull;
+		struct cull_constant_t {
+			glm::mat4 mvp;
+			std::uint32_t count;
+			std::uint32_t skip_texid;
+			std::uint32_t lod;
+		};
+		float cell_scale = 0.2f;
+		glm::vec4 palette = glm::vec4(0.2f, 1.0f, 0.5f, 0.8f);
+		// i j k l pan, z x zoom, the command buffers are recorded again when it moves
+		struct camera_t {
+			glm::vec2 center = glm::vec2(1.5f, 1.0f); // world units, a cell is cell_scale wide
+			float distance = 1.0f;
+		}camera;
+		/*
+			the board is split into chunk_size x chunk_size chunks, chunk i owns the instance slots [i * chunk_cells, (i + 1) * chunk_cells)
+			only the chunks in view are written and drawn, a chunk on the board edge packs its cells row by row and leaves the rest unused
+		*/
+		std::uint32_t chunk_size = 32;
+		/*
+			level l > 0 stores the dominant cell of every 2^l x 2^l block of the board, level 0 is the map itself
+			zoomed out, the finest level whose cells cover at least lod_pixels on screen is drawn in place of the board,
+			so the written and drawn instances are bounded by the screen and not by the board
+		*/
+		struct {
+			std::vector<core::extent2_t<std::size_t>> extents;
+			std::vector<std::vector<cell_e>> levels;
+			std::vector<std::vector<std::uint64_t>> revisions; // per level and chunk, the update_lod() its cells last changed in
+			std::uint64_t revision = 0;
+		}lod;
+		float lod_pixels = 2.0f;
+		// dispatch arguments of the cull pass, followed by the indices of the chunks in view
+		struct chunk_list_t {
+			vk::DispatchIndirectCommand dispatch;
+			std::uint32_t count;
+		};
 
 		struct {
 			std::vector<vertex_t> vertex = {
@@ -266,9 +434,20 @@ private:
 		struct {
 			vku::buffer_t vertex;
 			vku::buffer_t index;
-			vku::buffer_t mvp;
-			vku::buffer_t instance;
+			vku::buffer_t visible;	// written by the cull pre-pass
+			vku::buffer_t indirect;	// vk::DrawIndexedIndirectCommand
 		}buffer;
+		// what the host writes, one copy per frame slot of the window so the frames in flight never see the writes of the next one
+		struct frame_t {
+			vku::buffer_t instance;
+			vku::buffer_t chunk_list;	// chunk_list_t, read by the cull pre-pass
+			vku::buffer_t chunk_draw;	// vk::DrawIndexedIndirectCommand per chunk, drawn without the cull pre-pass
+			vk::DescriptorSet cull_set;
+			std::vector<std::uint32_t> chunk_levels; // 1 + the level whose cells a chunk slot holds, 0 while it is unused
+			std::vector<std::uint64_t> chunk_revisions; // lod.revision when the cells of a chunk slot were written
+			std::vector<std::uint32_t> drawn_chunks; // in view at the last update_instance() of this slot
+		};
+		std::vector<frame_t> frames;
 		struct {
 			vk::Image image;
 			vk::ImageLayout layout;
@@ -279,152 +458,388 @@ private:
 			vk::Sampler sampler;
 		}texture;
 
-		decltype(auto) update_mvp() {
-			auto extent = window->extent();
+		// premultiplied once per recording, the command buffers are recorded again whenever the extent or the camera changes
+		decltype(auto) mvp(vk::Extent2D const& extent) const {
 			auto radians = 90.0f;
 			auto width = static_cast<float>(extent.width);
 			auto height = static_cast<float>(extent.height);
 
-			auto& mvp = core::memory_view_t(buffer.mvp.byte(), buffer.mvp.map()).ref<mvp_t>();
-
-			mvp.proj = glm::perspective(glm::radians(radians), 1.0f, 0.0f, 100.0f);
+			auto proj = glm::perspective(glm::radians(radians), 1.0f, 0.0f, 100.0f);
 
-			width >= height ? mvp.proj[0][0] *= (height / width) : mvp.proj[1][1] *= (width / height);
+			width >= height ? proj[0][0] *= (height / width) : proj[1][1] *= (width / height);
 
-			mvp.view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f));
-			mvp.model = glm::mat4(1.0f);
-			mvp.model = glm::translate(mvp.model, glm::vec3(-1.5f, -1.0f, 0.0f));
-			buffer.mvp.unmap();
+			auto view = glm::translate(glm::mat4(1.0f), glm::vec3(-camera.center, -camera.distance));
+			return proj * view;
 		}
-		decltype(auto) update_instance() {
-			auto extent = core::extent2_t<std::size_t>{ map->at(0).size(), map->size() };
-			auto count = buffer.instance.byte() / sizeof(instance_t);
-			assert(extent.width() * extent.height() == count);
-			auto instance_view = core::memory_view_t(buffer.instance.byte(), buffer.instance.map());
-			float scale = 0.2f;
-			float alpha = 0.8f;
-			for (std::size_t y = 0; y < extent.height(); ++y) {
-				for (std::size_t x = 0; x < extent.width(); ++x) {
-					auto& instance = instance_view.sub_view((y * extent.width() + x) * sizeof(instance_t), sizeof(instance_t)).ref<instance_t>();
-					instance.texture_index = (std::uint32_t)map->at(y)[x];
-					instance.color = glm::vec4(0.2f, 1.0f, 0.5f, alpha);
-					instance.scale = glm::vec3(scale, scale, 1.0f);
-					instance.pos = glm::vec3(x * scale, y * scale, 0.0f);
+		decltype(auto) move_camera(dev::key_e key) {
+			auto step = camera.distance * 0.2f;
+			switch (key) {
+			case dev::key_e::e_i: camera.center.y -= step; break;
+			case dev::key_e::e_k: camera.center.y += step; break;
+			case dev::key_e::e_j: camera.center.x -= step; break;
+			case dev::key_e::e_l: camera.center.x += step; break;
+			case dev::key_e::e_z: camera.distance = (std::max)(camera.distance * 0.8f, 0.05f); break;
+			case dev::key_e::e_x: camera.distance = (std::min)(camera.distance * 1.25f, 1000.0f); break;
+			default: return false;
+			}
+			return true;
+		}
+		decltype(auto) lod_cell(std::size_t level, std::size_t x, std::size_t y) const {
+			return level == 0 ? map->at(y)[x] : lod.levels[level][y * lod.extents[level].width() + x];
+		}
+		// the most frequent of the up to four children, ties go to the cell that matters most to the player
+		decltype(auto) lod_dominant(std::size_t level, std::size_t x, std::size_t y) const {
+			constexpr int priority[] = { 0, 1, 4, 5, 3, 2, 0 }; // indexed by cell_e
+			int count[(std::size_t)cell_e::e_null + 1] = {};
+			auto& child = lod.extents[level - 1];
+			auto result = cell_e::e_empty;
+			for (std::size_t i = 0; i < 4; ++i) {
+				auto cx = x * 2 + (i & 1), cy = y * 2 + (i >> 1);
+				if (cx >= child.width() || cy >= child.height()) continue;
+				auto cell = lod_cell(level - 1, cx, cy);
+				auto n = ++count[(std::size_t)cell];
+				auto best = count[(std::size_t)result];
+				if (n > best || (n == best && priority[(std::size_t)cell] > priority[(std::size_t)result])) result = cell;
+			}
+			return result;
+		}
+		decltype(auto) build_lod() {
+			lod.extents = { core::extent2_t<std::size_t>{ map->at(0).size(), map->size() } };
+			lod.levels = { {} };
+			lod.revisions.clear();
+			while (lod.extents.back().width() > 1 || lod.extents.back().height() > 1) {
+				auto child = lod.extents.back();
+				lod.extents.push_back({ (child.width() + 1) / 2, (child.height() + 1) / 2 });
+				lod.levels.emplace_back(lod.extents.back().width() * lod.extents.back().height());
+				auto level = lod.levels.size() - 1;
+				for (std::size_t y = 0; y < lod.extents[level].height(); ++y) {
+					for (std::size_t x = 0; x < lod.extents[level].width(); ++x) lod.levels[level][y * lod.extents[level].width() + x] = lod_dominant(level, x, y);
+				}
+			}
+			for (std::uint32_t level = 0; level < lod.levels.size(); ++level) lod.revisions.emplace_back(chunk_count(level), 0);
+		}
+		decltype(auto) touch_chunk(std::size_t level, std::size_t x, std::size_t y) {
+			lod.revisions[level][y / chunk_size * chunk_extent(static_cast<std::uint32_t>(level)).width() + x / chunk_size] = lod.revision;
+		}
+		// walks up from every changed cell, stops as soon as a level keeps its value, the chunks it went through are marked changed
+		decltype(auto) update_lod() {
+			CW_TRACE_ZONE("vulkan::update_lod");
+			if (!changed->empty()) ++lod.revision;
+			for (const auto& iter : *changed) {
+				auto x = static_cast<std::size_t>(iter.x()), y = static_cast<std::size_t>(iter.y());
+				touch_chunk(0, x, y);
+				for (std::size_t level = 1; level < lod.levels.size(); ++level) {
+					x /= 2, y /= 2;
+					auto cell = lod_dominant(level, x, y);
+					auto& stored = lod.levels[level][y * lod.extents[level].width() + x];
+					if (stored == cell) break;
+					stored = cell;
+					touch_chunk(level, x, y);
 				}
 			}
-			buffer.instance.unmap();
+			changed->clear();
+		}
+		// a world unit covers min(width, height) / (2 * distance) pixels, a cell of level l is 2^l cells wide
+		decltype(auto) lod_level(vk::Extent2D const& extent) const {
+			std::uint32_t level = 0;
+			auto cell_pixels = cell_scale * (std::min)(extent.width, extent.height) / (2.0f * camera.distance);
+			while (level + 1 < lod.levels.size() && cell_pixels < lod_pixels) { ++level; cell_pixels *= 2.0f; }
+			return level;
+		}
+		// temporaries of the current frame, they don't touch the heap once the arena is warm
+		template<typename _type> decltype(auto) transient() const { return core::frame_vector_t<_type>(core::frame_allocator_t<_type>(arena)); }
+		decltype(auto) chunk_cells() const { return chunk_size * chunk_size; }
+		decltype(auto) chunk_extent(std::uint32_t level = 0) const {
+			auto& extent = lod.extents[level];
+			return core::extent2_t<std::size_t>{ (extent.width() + chunk_size - 1) / chunk_size, (extent.height() + chunk_size - 1) / chunk_size };
+		}
+		decltype(auto) chunk_count(std::uint32_t level = 0) const { return static_cast<std::uint32_t>(chunk_extent(level).width() * chunk_extent(level).height()); }
+		// cells of the level inside the chunk
+		decltype(auto) chunk_rect(std::uint32_t chunk, std::uint32_t level) const {
+			auto& extent = lod.extents[level];
+			auto chunks = chunk_extent(level);
+			auto x = chunk % chunks.width() * chunk_size, y = chunk / chunks.width() * chunk_size;
+			return core::rect_t<core::offset2_t<std::size_t>, core::extent2_t<std::size_t>>{
+				{ x, y }, { (std::min)(std::size_t(chunk_size), extent.width() - x), (std::min)(std::size_t(chunk_size), extent.height() - y) }
+			};
+		}
+		// at the camera distance the 90 degree frustum spans distance * aspect on each side of the center
+		decltype(auto) visible_chunks(vk::Extent2D const& extent, std::uint32_t level) const {
+			auto result = transient<std::uint32_t>();
+			if (extent.width == 0 || extent.height == 0) return result;
+			auto width = static_cast<float>(extent.width);
+			auto height = static_cast<float>(extent.height);
+			auto half = (width >= height ? glm::vec2(width / height, 1.0f) : glm::vec2(1.0f, height / width)) * camera.distance;
+			auto chunks = chunk_extent(level);
+			auto chunk_world = chunk_size * cell_scale * static_cast<float>(1u << level);
+			auto begin = glm::max(glm::floor((camera.center - half) / chunk_world), glm::vec2(0.0f));
+			auto end = glm::min(glm::ceil((camera.center + half) / chunk_world), glm::vec2(chunks.width(), chunks.height()));
+			for (auto y = begin.y; y < end.y; ++y) {
+				for (auto x = begin.x; x < end.x; ++x) result.push_back(static_cast<std::uint32_t>(y) * static_cast<std::uint32_t>(chunks.width()) + static_cast<std::uint32_t>(x));
+			}
+			return result;
+		}
+		/*
+			the cell indices of a slot only change with the level it holds, so while it keeps its level only texture_index is scattered into it, row by row,
+			and only when the cells changed since the frame slot last wrote it
+			the slots after the cells of a chunk on the edge are marked unused, they may still hold another level
+		*/
+		decltype(auto) write_chunk(frame_t& frame, core::memory_view_t const& instances, std::uint32_t chunk, std::uint32_t level) {
+			static_assert(sizeof(cell_e) == sizeof(std::uint32_t), "cells are scattered into texture_index as they are");
+			if (frame.chunk_levels[chunk] == level + 1 && frame.chunk_revisions[chunk] >= lod.revisions[level][chunk]) return;
+			auto rect = chunk_rect(chunk, level);
+			auto width = lod.extents[level].width();
+			auto slice = core::strided_view_t<instance_t>(instances).sub_view(static_cast<std::size_t>(chunk) * chunk_cells(), chunk_cells());
+			auto cells = slice.field<std::uint32_t>(offsetof(instance_t, cell));
+			auto textures = slice.field<cell_e>(offsetof(instance_t, texture_index));
+			auto row = rect.m_extent.width(), used = rect.m_extent.width() * rect.m_extent.height();
+			if (frame.chunk_levels[chunk] != level + 1) {
+				for (std::size_t y = 0; y < rect.m_extent.height(); ++y) core::func::iota(cells.sub_view(y * row, row), static_cast<std::uint32_t>((rect.m_offset.y() + y) * width + rect.m_offset.x()));
+				core::func::fill(cells.sub_view(used, chunk_cells() - used), ~0u);
+				core::func::fill(textures.sub_view(used, chunk_cells() - used), cell_e::e_empty);
+				frame.chunk_levels[chunk] = level + 1;
+			}
+			frame.chunk_revisions[chunk] = lod.revision;
+			for (std::size_t y = 0; y < rect.m_extent.height(); ++y) {
+				auto cy = rect.m_offset.y() + y;
+				auto source = level == 0 ? map->at(cy).data() : lod.levels[level].data() + cy * width;
+				core::func::scatter(source + rect.m_offset.x(), textures.sub_view(y * row, row));
+			}
+		}
+		decltype(auto) specialization() const {
+			return specialization_t{ static_cast<std::uint32_t>(map->at(0).size()), static_cast<std::uint32_t>(map->size()), cell_scale, palette, chunk_cells() };
+		}
+		decltype(auto) specialization_entries() const {
+			auto entries = transient<vk::SpecializationMapEntry>();
+			entries.push_back(vk::SpecializationMapEntry(0, offsetof(specialization_t, grid_width), sizeof(std::uint32_t)));
+			entries.push_back(vk::SpecializationMapEntry(1, offsetof(specialization_t, grid_height), sizeof(std::uint32_t)));
+			entries.push_back(vk::SpecializationMapEntry(2, offsetof(specialization_t, cell_scale), sizeof(float)));
+			for (std::uint32_t i = 0; i < 4; ++i) entries.push_back(vk::SpecializationMapEntry(3 + i, offsetof(specialization_t, palette) + i * sizeof(float), sizeof(float)));
+			entries.push_back(vk::SpecializationMapEntry(7, offsetof(specialization_t, chunk_cells), sizeof(std::uint32_t)));
+			return entries;
+		}
+		// only the chunks of the drawn level in view are written, then handed to the cull pre-pass or to their own draws
+		decltype(auto) update_instance() {
+			CW_TRACE_ZONE("vulkan::update_instance");
+			// only the copies of the frame slot run() submits next are rewritten, the other frames stay in flight
+			auto& frame = frames[window->wait_frame()];
+			assert(frame.instance.byte() == sizeof(instance_t) * chunk_count() * chunk_cells());
+			auto level = lod_level(window->extent());
+			auto chunks = visible_chunks(window->extent(), level);
+			auto instances = core::memory_view_t(frame.instance.byte(), frame.instance.map());
+			for (auto chunk : chunks) write_chunk(frame, instances, chunk, level);
+			frame.instance.unmap();
+			if (cull.pipeline) {
+				// one work group row per chunk, maxComputeWorkGroupCount[1] is at least 65535
+				auto list = reinterpret_cast<chunk_list_t*>(frame.chunk_list.map());
+				list->count = static_cast<std::uint32_t>((std::min)(chunks.size(), std::size_t(65535)));
+				list->dispatch = vk::DispatchIndirectCommand((chunk_cells() + 63) / 64, list->count, 1);
+				std::copy(chunks.begin(), chunks.begin() + list->count, reinterpret_cast<std::uint32_t*>(list + 1));
+				frame.chunk_list.unmap();
+			}
+			else {
+				auto draws = reinterpret_cast<vk::DrawIndexedIndirectCommand*>(frame.chunk_draw.map());
+				for (auto chunk : frame.drawn_chunks) draws[chunk].instanceCount = 0;
+				for (auto chunk : chunks) draws[chunk].instanceCount = static_cast<std::uint32_t>(chunk_rect(chunk, level).m_extent.width() * chunk_rect(chunk, level).m_extent.height());
+				frame.chunk_draw.unmap();
+			}
+			frame.drawn_chunks.assign(chunks.begin(), chunks.end());
 		}
 
 		decltype(auto) build_vulkan(std::unique_ptr<dev::window_group_t>& window_group) {
+			// no window was opened, draw into offscreen images without a surface
+			auto headless = window_group->headless();
 			device = std::make_unique<vku::device_t>(
 				vku::device_ci_t()
-				.set_usage(vku::device_usage_t())
+				.set_surface(!headless.has_value())
+				.set_usage(vku::device_usage_t().set_descriptor_indexing(true))
 				//.set_debug(false)
 				//.set_monitor(false)
 				);
-			window = std::make_unique<vku::window_t>(
-				vku::window_ci_t()
+			auto window_ci = vku::window_ci_t()
 				.set_device(device.get())
 				.set_vsync(vsync)
-				.set_hinstance(dev::priv::get_hinstance(window_group.get()))
-				.set_hwnd(dev::priv::get_hwnd(window_group.get()))
-				);
+				.set_profile(profile_interval != 0);
+			// set before creation, so the swapchain is only built once
+			if (present_policy != vku::present_policy_e::e_null) window_ci.set_present_policy(present_policy);
+			// the render funcs only read the renderer state, so they can be recorded concurrently
+			if (record_threads != 0) {
+				record_pool = std::make_unique<core::thread_pool_t>(record_threads);
+				window_ci.set_thread_pool(record_pool.get());
+			}
+			if (headless.has_value()) window_ci.set_offscreen(vku::window_offscreen_t().set_extent({ headless.value().width(), headless.value().height() }));
+			else {
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+				window_ci
+					.set_hinstance(dev::priv::get_hinstance(window_group.get()))
+					.set_hwnd(dev::priv::get_hwnd(window_group.get()));
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+				window_ci
+					.set_xcb_connection(dev::priv::get_xcb_connection(window_group.get()))
+					.set_xcb_window(dev::priv::get_xcb_window(window_group.get()));
+#endif
+			}
+			window = std::make_unique<vku::window_t>(window_ci);
+			window->set_profile_log(profile_interval);
+			if (!capture_path.empty()) window->capture([path = capture_path](vku::capture_frame_t const& frame) { if (vku::func::write_capture_ppm(path, frame)) std::cout << "frame " << frame.frame << " captured to " << path << std::endl; });
+			if (window->is_offscreen()) std::cout << "headless, drawing offscreen at " << headless.value().width() << "x" << headless.value().height() << std::endl;
+			else std::cout << "present mode : " << vk::to_string(window->present_mode()) << ", " << window->image_count() << " images" << std::endl;
 		}
 		decltype(auto) clean_vulkan() {
 			window = nullptr;
+			record_pool = nullptr;
 			device = nullptr;
 		}
 		decltype(auto) build_buffer() {
-			// vertex buffer
+			// vertex buffer, staged only when the chosen memory isn't host visible
 			buffer.vertex = vku::buffer_t(
 				vku::buffer_ci_t()
 				.set_device(device.get())
-				.set_usage_flags(vk::BufferUsageFlagBits::eTransferSrc)
-				.set_memory_flags(vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)
+				.set_usage_flags(vk::BufferUsageFlagBits::eVertexBuffer)
+				.set_intent(vku::memory_intent_e::e_static)
 				.set_memory_view(data.vertex)
-			).copy(vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
+			);
 			// index buffer
 			buffer.index = vku::buffer_t(
 				vku::buffer_ci_t()
 				.set_device(device.get())
-				.set_usage_flags(vk::BufferUsageFlagBits::eTransferSrc)
-				.set_memory_flags(vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)
+				.set_usage_flags(vk::BufferUsageFlagBits::eIndexBuffer)
+				.set_intent(vku::memory_intent_e::e_static)
 				.set_memory_view(data.index)
-			).copy(vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
-			// ubo buffer
-			buffer.mvp = vku::buffer_t(
+			);
+			auto count = static_cast<std::size_t>(chunk_count()) * chunk_cells();
+			std::vector<vk::DrawIndexedIndirectCommand> chunk_draws(chunk_count(), vk::DrawIndexedIndirectCommand().setIndexCount(static_cast<std::uint32_t>(data.index.size())));
+			frames.resize(window->frame_count());
+			for (auto& frame : frames) {
+				// instance buffer, sliced into chunks
+				frame.instance = vku::buffer_t(
+					vku::buffer_ci_t()
+					.set_device(device.get())
+					.set_usage_flags(vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer)
+					.set_intent(vku::memory_intent_e::e_upload) // written every frame, directly into vram on rebar / uma devices
+					.set_byte(sizeof(instance_t) * count)
+				);
+				// unused slots hold an out of range cell, which the cull pre-pass skips, level 0 has the most chunks
+				auto instances = reinterpret_cast<instance_t*>(frame.instance.map());
+				std::fill(instances, instances + count, instance_t{ ~0u, (std::uint32_t)cell_e::e_empty });
+				frame.instance.unmap();
+				frame.chunk_levels.assign(chunk_count(), 0);
+				frame.chunk_revisions.assign(chunk_count(), 0);
+				frame.drawn_chunks.clear();
+				// chunks in view
+				frame.chunk_list = vku::buffer_t(
+					vku::buffer_ci_t()
+					.set_device(device.get())
+					.set_usage_flags(vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer)
+					.set_intent(vku::memory_intent_e::e_upload)
+					.set_byte(sizeof(chunk_list_t) + sizeof(std::uint32_t) * chunk_count())
+				);
+				std::memset(frame.chunk_list.map(), 0, frame.chunk_list.byte());
+				frame.chunk_list.unmap();
+				frame.chunk_draw = vku::buffer_t(
+					vku::buffer_ci_t()
+					.set_device(device.get())
+					.set_usage_flags(vk::BufferUsageFlagBits::eIndirectBuffer)
+					.set_intent(vku::memory_intent_e::e_upload)
+					.set_byte(sizeof(vk::DrawIndexedIndirectCommand) * chunk_count())
+				);
+				std::memcpy(frame.chunk_draw.map(), chunk_draws.data(), frame.chunk_draw.byte());
+				frame.chunk_draw.unmap();
+			}
+			// culled instance buffer and its draw arguments
+			buffer.visible = vku::buffer_t(
 				vku::buffer_ci_t()
 				.set_device(device.get())
-				.set_usage_flags(vk::BufferUsageFlagBits::eUniformBuffer)
-				.set_memory_flags(vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)
-				//.set_memory_view(m_ubo)
-				.set_byte(sizeof(mvp_t))
+				.set_usage_flags(vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer)
+				.set_intent(vku::memory_intent_e::e_static)
+				.set_byte(sizeof(instance_t) * count)
 			);
-			update_mvp();
-			// instance buffer
-			auto count = map->size() * map->at(0).size();
-			buffer.instance = vku::buffer_t(
+			buffer.indirect = vku::buffer_t(
 				vku::buffer_ci_t()
 				.set_device(device.get())
-				.set_usage_flags(vk::BufferUsageFlagBits::eVertexBuffer)
-				.set_memory_flags(vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)
-				//.set_memory_view(m_ubo)
-				.set_byte(sizeof(instance_t) * count)
+				.set_usage_flags(vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
+				.set_intent(vku::memory_intent_e::e_static)
+				.set_byte(sizeof(vk::DrawIndexedIndirectCommand))
 			);
-			update_instance();
 		}
+		// the clean_* functions hand everything to the device, it is destroyed once the frames in flight have completed
 		decltype(auto) clean_buffer() {
-			buffer.instance = nullptr;
-			buffer.mvp = nullptr;
-			buffer.index = nullptr;
-			buffer.vertex = nullptr;
+			for (auto& frame : frames) {
+				frame.chunk_draw.retire();
+				frame.chunk_list.retire();
+				frame.instance.retire();
+			}
+			frames.clear();
+			buffer.indirect.retire();
+			buffer.visible.retire();
+			buffer.index.retire();
+			buffer.vertex.retire();
 		}
-		decltype(auto) build_texture() {
-			struct texture_t {
-				texture_t(const char* path) {
-					data = stbi_load(path, &width, &height, &channel, STBI_rgb_alpha);
-				}
-				~texture_t() {
-					stbi_image_free(data);
-				}
-				decltype(auto) byte()const noexcept { return width * height * channel * sizeof(core::u8_t); }
-
-				int width = 0, height = 0, channel = 0;
-				core::u8_t* data = nullptr;
-			};
-			auto layer_count = (std::uint32_t)cell_e::e_null;
-
-			texture_t res_empty("./res/texture/empty.png");
-
-			auto buffer = vku::buffer_t(
+		struct texture_staging_t {
+			vku::buffer_t buffer;
+			vk::Format format = vk::Format::eR8G8B8A8Unorm;
+			std::uint32_t width = 0, height = 0;
+			std::vector<vk::DeviceSize> layer_offsets;
+		};
+		// pre-decoded bundle : the mapped file is copied into the staging buffer in one go
+		decltype(auto) load_texture_bundle(texture_staging_t& staging) {
+			vku::texture_bundle_t bundle(texture_bundle_path);
+			if (!bundle.is_valid() || bundle.layer_count() != (std::uint32_t)cell_e::e_null) return false;
+			auto features = vk::FormatProperties(vk::FormatFeatureFlags(), vk::FormatFeatureFlagBits::eSampledImage, vk::FormatFeatureFlags());
+			if (!vku::func::find_formats(*device, { bundle.format() }, features).has_value()) return false;
+			staging.buffer = vku::buffer_t(
 				vku::buffer_ci_t()
 				.set_device(device.get())
 				.set_usage_flags(vk::BufferUsageFlagBits::eTransferSrc)
-				.set_memory_flags(vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)
-				.set_byte(res_empty.byte() * layer_count)
+				.set_intent(vku::memory_intent_e::e_staging)
+				.set_memory_view(bundle.data())
 			);
-
-			auto to_name = [](cell_e cell) {
-				switch (cell) {
-				case cell_e::e_empty:return std::string("empty");
-				case cell_e::e_wall :return std::string("wall");
-				case cell_e::e_food :return std::string("food");
-				case cell_e::e_head :return std::string("head");
-				case cell_e::e_body :return std::string("body");
-				case cell_e::e_tail :return std::string("tail");
-				case cell_e::e_null :return std::string("null");
+			staging.format = bundle.format();
+			staging.width = bundle.width();
+			staging.height = bundle.height();
+			for (std::uint32_t i = 0; i < bundle.layer_count(); ++i) staging.layer_offsets.push_back(bundle.layer_offset(i));
+			return true;
+		}
+		/*
+			fallback : decode the png files on a thread pool, then fill the staging buffer under a single map
+			a png which can't be decoded or doesn't match the size of the first decoded one is drawn as a flat white placeholder
+		*/
+		void load_texture_files(texture_staging_t& staging) {
+			auto textures = decode_textures(texture_directory);
+			auto first = std::find_if(textures.begin(), textures.end(), [](std::unique_ptr<texture_t> const& iter) { return iter->data != nullptr; });
+			if (first == textures.end()) std::cerr << "can't decode any cell texture in \"" << texture_directory << "\", every cell is drawn as a placeholder" << std::endl;
+			auto width = first != textures.end() ? (*first)->width : 1, height = first != textures.end() ? (*first)->height : 1;
+			auto layer_byte = static_cast<std::size_t>(width) * height * STBI_rgb_alpha;
+			staging.buffer = vku::buffer_t(
+				vku::buffer_ci_t()
+				.set_device(device.get())
+				.set_usage_flags(vk::BufferUsageFlagBits::eTransferSrc)
+				.set_intent(vku::memory_intent_e::e_staging)
+				.set_byte(layer_byte * textures.size())
+			);
+			auto staging_view = core::memory_view_t(staging.buffer.byte(), staging.buffer.map());
+			for (std::size_t i = 0; i < textures.size(); ++i) {
+				if (textures[i]->data && textures[i]->width == width && textures[i]->height == height) staging_view.copy_from(layer_byte, textures[i]->data, layer_byte * i);
+				else {
+					if (textures[i]->data) std::cerr << "cell texture \"" << to_name(static_cast<cell_e>(i)) << "\" is " << textures[i]->width << "x" << textures[i]->height << " instead of " << width << "x" << height << ", a placeholder is drawn" << std::endl;
+					std::memset(static_cast<core::u8_t*>(staging_view.data()) + layer_byte * i, 0xff, layer_byte);
 				}
-				return std::string("");
-			};
-
-			for (auto i = (std::uint32_t)cell_e::e_empty; i < (std::uint32_t)cell_e::e_null; ++i) {
-				auto path = std::string("./res/texture/") + to_name(static_cast<cell_e>(i)) + ".png";
-				texture_t tex(path.c_str());
-				assert(tex.byte() == res_empty.byte());
-				buffer.copy_from({ tex.byte() , tex.data }, std::nullopt, 0, tex.byte() * i);
+				staging.layer_offsets.push_back(layer_byte * i);
 			}
+			staging.buffer.unmap();
+			staging.format = vk::Format::eR8G8B8A8Unorm;
+			staging.width = static_cast<std::uint32_t>(width);
+			staging.height = static_cast<std::uint32_t>(height);
+		}
+		decltype(auto) build_texture() {
+			auto layer_count = (std::uint32_t)cell_e::e_null;
+
+			texture_staging_t staging;
+			if (!load_texture_bundle(staging)) load_texture_files(staging);
+			auto& buffer = staging.buffer;
 
-			auto format = vk::Format::eR8G8B8A8Unorm;
+			auto format = staging.format;
 			//auto format = vk::Format::eR8G8B8A8Uint;
 
 			auto imageCreateInfo = vk::ImageCreateInfo();
@@ -434,17 +849,14 @@ private:
 			imageCreateInfo.tiling = vk::ImageTiling::eOptimal;
 			imageCreateInfo.sharingMode = vk::SharingMode::eExclusive;
 			imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
-			imageCreateInfo.extent = { (std::uint32_t)res_empty.width, (std::uint32_t)res_empty.height, 1 };
+			imageCreateInfo.extent = { staging.width, staging.height, 1 };
 			imageCreateInfo.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
 			imageCreateInfo.arrayLayers = layer_count;
 			imageCreateInfo.mipLevels = 1;
 			
 			texture.image = vk::Device(*device).createImage(imageCreateInfo);
 			auto memReqs = vk::Device(*device).getImageMemoryRequirements(texture.image);
-			auto memAllocInfo = vk::MemoryAllocateInfo();
-			memAllocInfo.allocationSize = memReqs.size;
-			memAllocInfo.memoryTypeIndex = device->find_memory_index(memReqs.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
-			texture.memory = vk::Device(*device).allocateMemory(memAllocInfo);
+			texture.memory = device->allocate_memory(memReqs, vk::MemoryPropertyFlagBits::eDeviceLocal);
 			vk::Device(*device).bindImageMemory(texture.image, texture.memory, 0);
 
 			std::vector<vk::BufferImageCopy> bufferCopyRegions;
@@ -456,13 +868,13 @@ private:
 				bufferCopyRegion.imageSubresource.mipLevel = 0;
 				bufferCopyRegion.imageSubresource.baseArrayLayer = layer;
 				bufferCopyRegion.imageSubresource.layerCount = 1;
-				bufferCopyRegion.imageExtent.width = res_empty.width;
-				bufferCopyRegion.imageExtent.height = res_empty.height;
+				bufferCopyRegion.imageExtent.width = staging.width;
+				bufferCopyRegion.imageExtent.height = staging.height;
 				bufferCopyRegion.imageExtent.depth = 1;
 				bufferCopyRegion.imageOffset.x = 0;
 				bufferCopyRegion.imageOffset.y = 0;
 				bufferCopyRegion.imageOffset.z = 0;
-				bufferCopyRegion.bufferOffset = res_empty.byte() * layer;
+				bufferCopyRegion.bufferOffset = staging.layer_offsets[layer];
 				bufferCopyRegions.push_back(bufferCopyRegion);
 			}
 
@@ -552,106 +964,75 @@ private:
 
 		}
 		decltype(auto) clean_texture() {
-			vk::Device(*device).destroySampler(texture.sampler);
-			vk::Device(*device).destroyImageView(texture.view);
-			vk::Device(*device).freeMemory(texture.memory);
-			vk::Device(*device).destroyImage(texture.image);
+			device->defer_destroy(texture.sampler);
+			device->defer_destroy(texture.view);
+			device->defer_destroy(texture.image);
+			device->defer_destroy(texture.memory);
 		}
 		decltype(auto) build_layout() {
+			descriptors = std::make_unique<vku::descriptor_allocator_t>(vku::descriptor_allocator_ci_t().set_device(device.get()));
+			// snake.frag samples binding 0 of set 0 : slot 0 of the bindless images, or a set of its own
+			auto set_layouts = transient<vk::DescriptorSetLayout>();
+			if (device->is_descriptor_indexing()) {
+				bindless = std::make_unique<vku::bindless_table_t>(
+					vku::bindless_table_ci_t()
+					.set_device(device.get())
+					.set_image_capacity(16)
+					.set_buffer_capacity(16)
+					.set_stage_flags(vk::ShaderStageFlagBits::eFragment)
+				);
+				auto slot = bindless->add_image(texture.view, texture.layout, texture.sampler);
+				assert(slot == 0);
+				set_layouts.push_back(bindless->layout());
+				pipeline.descriptor_sets.push_back(bindless->set());
+			}
+			else {
+				auto descriptor_set_layout_bindings_u = transient<vk::DescriptorSetLayoutBinding>();
+				descriptor_set_layout_bindings_u.push_back(
+					vk::DescriptorSetLayoutBinding()
+					.setStageFlags(vk::ShaderStageFlagBits::eFragment)
+					.setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+					.setDescriptorCount(1)
+					.setBinding(0)
+				);
+				pipeline.descriptor_set_layouts.push_back(
+					vk::Device(*device).createDescriptorSetLayout(
+						vk::DescriptorSetLayoutCreateInfo()
+						.setBindingCount(descriptor_set_layout_bindings_u.size())
+						.setPBindings(descriptor_set_layout_bindings_u.data())
+					)
+				);
+				set_layouts.push_back(pipeline.descriptor_set_layouts.back());
+				pipeline.descriptor_sets.push_back(descriptors->allocate(pipeline.descriptor_set_layouts.back()));
+				vku::descriptor_writer_t()
+					.write_image(0, vk::DescriptorType::eCombinedImageSampler, texture.view, texture.layout, texture.sampler)
+					.update(device.get(), pipeline.descriptor_sets[0]);
+			}
+
 			// pipeline layout
-			std::vector<vk::DescriptorSetLayoutBinding> descriptor_set_layout_bindings_u;
-			descriptor_set_layout_bindings_u.push_back(
-				vk::DescriptorSetLayoutBinding()
+			auto push_constant_range = vk::PushConstantRange()
 				.setStageFlags(vk::ShaderStageFlagBits::eVertex)
-				.setDescriptorType(vk::DescriptorType::eUniformBuffer)
-				.setDescriptorCount(1)
-				.setBinding(0)
-			);
-			descriptor_set_layout_bindings_u.push_back(
-				vk::DescriptorSetLayoutBinding()
-				.setStageFlags(vk::ShaderStageFlagBits::eFragment)
-				.setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
-				.setDescriptorCount(1)
-				.setBinding(1)
-			);
-			pipeline.descriptor_set_layouts.push_back(
-				vk::Device(*device).createDescriptorSetLayout(
-					vk::DescriptorSetLayoutCreateInfo()
-					.setBindingCount(descriptor_set_layout_bindings_u.size())
-					.setPBindings(descriptor_set_layout_bindings_u.data())
-				)
-			);
+				.setOffset(0)
+				.setSize(sizeof(constant_t));
 			pipeline.pipeline_layout = vk::Device(*device).createPipelineLayout(
 				vk::PipelineLayoutCreateInfo()
-				.setSetLayoutCount(pipeline.descriptor_set_layouts.size())
-				.setPSetLayouts(pipeline.descriptor_set_layouts.data())
-			);
-
-			// descriptor
-			std::vector<vk::DescriptorPoolSize> pool_sizes;
-			pool_sizes.push_back(
-				vk::DescriptorPoolSize()
-				.setType(vk::DescriptorType::eUniformBuffer)
-				.setDescriptorCount(1)
+				.setSetLayoutCount(set_layouts.size())
+				.setPSetLayouts(set_layouts.data())
+				.setPushConstantRangeCount(1)
+				.setPPushConstantRanges(&push_constant_range)
 			);
-			pool_sizes.push_back(
-				vk::DescriptorPoolSize()
-				.setType(vk::DescriptorType::eCombinedImageSampler)
-				.setDescriptorCount(1)
-			);
-			auto descriptor_pool_ci = vk::DescriptorPoolCreateInfo()
-				.setPoolSizeCount(pool_sizes.size())
-				.setPPoolSizes(pool_sizes.data())
-				.setMaxSets(2);
-
-			pipeline.descriptor_pool = vk::Device(*device).createDescriptorPool(descriptor_pool_ci);
-
-			auto descriptor_set_ai = vk::DescriptorSetAllocateInfo()
-				.setDescriptorPool(pipeline.descriptor_pool)
-				.setDescriptorSetCount(pipeline.descriptor_set_layouts.size())
-				.setPSetLayouts(pipeline.descriptor_set_layouts.data());
-
-			pipeline.descriptor_sets = vk::Device(*device).allocateDescriptorSets(descriptor_set_ai);
-
-			// mvp
-			auto descriptor_buffer_info = vk::DescriptorBufferInfo()
-				.setBuffer(buffer.mvp)
-				.setOffset(0)
-				.setRange(buffer.mvp.byte());
-			auto buffer_write = vk::WriteDescriptorSet()
-				.setDescriptorType(vk::DescriptorType::eUniformBuffer)
-				.setDescriptorCount(1)
-				.setDstSet(pipeline.descriptor_sets[0])
-				.setDstBinding(0)
-				.setPBufferInfo(&descriptor_buffer_info);
-			// image
-			auto descriptor_image_info = vk::DescriptorImageInfo()
-				.setImageView(texture.view)
-				.setImageLayout(texture.layout)
-				.setSampler(texture.sampler);
-			auto image_write = vk::WriteDescriptorSet()
-				.setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
-				.setDescriptorCount(1)
-				.setDstSet(pipeline.descriptor_sets[0])
-				.setDstBinding(1)
-				.setPImageInfo(&descriptor_image_info);
-			// write
-			std::vector<vk::WriteDescriptorSet> write_descriptor_sets;
-			write_descriptor_sets.push_back(buffer_write);
-			write_descriptor_sets.push_back(image_write);
-			vk::Device(*device).updateDescriptorSets(write_descriptor_sets, 0);
-
 		}
 		decltype(auto) clean_layout() {
-			vk::Device(*device).destroyDescriptorPool(pipeline.descriptor_pool);
-			//vk::Device(*device).freeDescriptorSets(pipeline.descriptor_pool, pipeline.descriptor_sets);
+			pipeline.descriptor_sets.clear();
+			descriptors = nullptr;
+			bindless = nullptr;
 
-			vk::Device(*device).destroyPipelineLayout(pipeline.pipeline_layout);
-			for (auto iter : pipeline.descriptor_set_layouts) vk::Device(*device).destroyDescriptorSetLayout(iter);
+			device->defer_destroy(pipeline.pipeline_layout);
+			for (auto iter : pipeline.descriptor_set_layouts) device->defer_destroy(iter);
 		}
 		decltype(auto) build_pipeline() {
 			// vertex input state
-			std::vector<vk::VertexInputBindingDescription> vertex_input_binding_descriptions;
+			auto vertex_input_binding_descriptions = transient<vk::VertexInputBindingDescription>();
 			vertex_input_binding_descriptions.push_back(
 				vk::VertexInputBindingDescription()
 				.setBinding(0)
@@ -664,7 +1045,7 @@ private:
 				.setInputRate(vk::VertexInputRate::eInstance)
 				.setStride(sizeof(instance_t))
 			);
-			std::vector<vk::VertexInputAttributeDescription> vertex_input_attribute_descriptions;
+			auto vertex_input_attribute_descriptions = transient<vk::VertexInputAttributeDescription>();
 			// vertex
 			std::uint32_t binding = 0, location = 0;
 			vertex_input_attribute_descriptions.push_back(
@@ -686,22 +1067,8 @@ private:
 				vk::VertexInputAttributeDescription()
 				.setBinding(binding)
 				.setLocation(location++)
-				.setFormat(vk::Format::eR32G32B32Sfloat)
-				.setOffset(offsetof(instance_t, pos))
-			);
-			vertex_input_attribute_descriptions.push_back(
-				vk::VertexInputAttributeDescription()
-				.setBinding(binding)
-				.setLocation(location++)
-				.setFormat(vk::Format::eR32G32B32Sfloat)
-				.setOffset(offsetof(instance_t, scale))
-			);
-			vertex_input_attribute_descriptions.push_back(
-				vk::VertexInputAttributeDescription()
-				.setBinding(binding)
-				.setLocation(location++)
-				.setFormat(vk::Format::eR32G32B32A32Sfloat)
-				.setOffset(offsetof(instance_t, color))
+				.setFormat(vk::Format::eR32Uint)
+				.setOffset(offsetof(instance_t, cell))
 			);
 			vertex_input_attribute_descriptions.push_back(
 				vk::VertexInputAttributeDescription()
@@ -717,12 +1084,20 @@ private:
 				.setVertexAttributeDescriptionCount(vertex_input_attribute_descriptions.size())
 				.setPVertexAttributeDescriptions(vertex_input_attribute_descriptions.data());
 			// shader
-			std::vector<vk::PipelineShaderStageCreateInfo> shader_cis;
+			auto specialization_data = specialization();
+			auto specialization_map = specialization_entries();
+			auto specialization_info = vk::SpecializationInfo()
+				.setMapEntryCount(specialization_map.size())
+				.setPMapEntries(specialization_map.data())
+				.setDataSize(sizeof(specialization_data))
+				.setPData(&specialization_data);
+			auto shader_cis = transient<vk::PipelineShaderStageCreateInfo>();
 			shader_cis.push_back(
 				vk::PipelineShaderStageCreateInfo()
 				.setStage(vk::ShaderStageFlagBits::eVertex)
 				.setModule(device->build_shader(vert_path))
 				.setPName("main")
+				.setPSpecializationInfo(&specialization_info)
 			);
 			shader_cis.push_back(
 				vk::PipelineShaderStageCreateInfo()
@@ -741,7 +1116,7 @@ private:
 				.setScissorCount(1)
 				.setPScissors(nullptr);
 			// dynamic 
-			std::vector<vk::DynamicState> dynamic_states;
+			auto dynamic_states = transient<vk::DynamicState>();
 			dynamic_states.push_back(vk::DynamicState::eViewport);
 			dynamic_states.push_back(vk::DynamicState::eScissor);
 			auto dynamic_ci = vk::PipelineDynamicStateCreateInfo()
@@ -753,7 +1128,7 @@ private:
 				DstColorBlendFactor : dst(rgb) = Old(rgb) * BlendFactor
 				ColorBlendOp		: new(rgb) = src(rgb) <BlendOp> dst(rgb)
 			*/
-			std::vector<vk::PipelineColorBlendAttachmentState> color_blend_attachment_states;
+			auto color_blend_attachment_states = transient<vk::PipelineColorBlendAttachmentState>();
 			color_blend_attachment_states.push_back(
 				vk::PipelineColorBlendAttachmentState()
 				.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA)
@@ -807,11 +1182,108 @@ private:
 			for (auto iter : shader_cis) device->clean_shader(iter.module);
 		}
 		decltype(auto) clean_pipeline() {
-			vk::Device(*device).destroyPipeline(pipeline.pipeline);
+			device->defer_destroy(pipeline.pipeline);
+		}
+		// without the compiled compute shader every instance is drawn directly
+		decltype(auto) build_cull() {
+			static_assert(sizeof(instance_t) == 8, "instance_t must match instance_t in cull.comp");
+			auto module = device->build_shader(cull_path);
+			if (!module) { std::cerr << "can't build the cull pipeline, compile cull.comp first : every instance is drawn without culling" << std::endl; return; }
+			auto bindings = transient<vk::DescriptorSetLayoutBinding>();
+			for (std::uint32_t i = 1; i < 5; ++i) bindings.push_back(vk::DescriptorSetLayoutBinding().setStageFlags(vk::ShaderStageFlagBits::eCompute).setDescriptorType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(1).setBinding(i));
+			cull.descriptor_set_layout = vk::Device(*device).createDescriptorSetLayout(
+				vk::DescriptorSetLayoutCreateInfo()
+				.setBindingCount(bindings.size())
+				.setPBindings(bindings.data())
+			);
+			auto push_constant_range = vk::PushConstantRange()
+				.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+				.setOffset(0)
+				.setSize(sizeof(cull_constant_t));
+			cull.pipeline_layout = vk::Device(*device).createPipelineLayout(
+				vk::PipelineLayoutCreateInfo()
+				.setSetLayoutCount(1)
+				.setPSetLayouts(&cull.descriptor_set_layout)
+				.setPushConstantRangeCount(1)
+				.setPPushConstantRanges(&push_constant_range)
+			);
+			// the instances and the chunk list are per frame slot, so is the set reading them
+			// the recorded commands keep the sets, a slot's pool is only recycled by the next build_cull with a new allocator
+			frame_descriptors = std::make_unique<vku::frame_descriptor_allocator_t>(vku::descriptor_allocator_ci_t().set_device(device.get()).set_set_count(1), static_cast<std::uint32_t>(frames.size()));
+			for (std::uint32_t slot = 0; slot < frames.size(); ++slot) {
+				auto& frame = frames[slot];
+				frame.cull_set = frame_descriptors->begin_frame(slot).allocate(cull.descriptor_set_layout);
+				vku::descriptor_writer_t()
+					.write_buffer(1, vk::DescriptorType::eStorageBuffer, frame.instance, frame.instance.byte())
+					.write_buffer(2, vk::DescriptorType::eStorageBuffer, buffer.visible, buffer.visible.byte())
+					.write_buffer(3, vk::DescriptorType::eStorageBuffer, buffer.indirect, buffer.indirect.byte())
+					.write_buffer(4, vk::DescriptorType::eStorageBuffer, frame.chunk_list, frame.chunk_list.byte())
+					.update(device.get(), frame.cull_set);
+			}
+			auto specialization_data = specialization();
+			auto specialization_map = specialization_entries();
+			auto specialization_info = vk::SpecializationInfo()
+				.setMapEntryCount(specialization_map.size())
+				.setPMapEntries(specialization_map.data())
+				.setDataSize(sizeof(specialization_data))
+				.setPData(&specialization_data);
+			cull.pipeline = vk::Device(*device).createComputePipeline(nullptr,
+				vk::ComputePipelineCreateInfo()
+				.setLayout(cull.pipeline_layout)
+				.setStage(
+					vk::PipelineShaderStageCreateInfo()
+					.setStage(vk::ShaderStageFlagBits::eCompute)
+					.setModule(module)
+					.setPName("main")
+					.setPSpecializationInfo(&specialization_info))
+			);
+			device->clean_shader(module);
+		}
+		decltype(auto) clean_cull() {
+			if (!cull.pipeline) return;
+			frame_descriptors = nullptr;
+			device->defer_destroy(cull.pipeline);
+			device->defer_destroy(cull.pipeline_layout);
+			device->defer_destroy(cull.descriptor_set_layout);
 		}
 		decltype(auto) render() {
-			window->caculate({
-				[this](vk::CommandBuffer cmd, vk::Rect2D rect) {
+			auto count = chunk_count() * chunk_cells();
+			auto index_count = static_cast<std::uint32_t>(buffer.index.byte() / sizeof(std::uint32_t));
+			if (cull.pipeline) {
+				window->set_prepass({
+					[this, count, index_count](vk::CommandBuffer cmd, vk::Rect2D rect, std::uint32_t slot) {
+						// the previous frame has to be done reading the visible instances and the arguments
+						cmd.pipelineBarrier(
+							vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+							vk::PipelineStageFlagBits::eTransfer,
+							vk::DependencyFlags(), nullptr, nullptr, nullptr
+						);
+						auto args = vk::DrawIndexedIndirectCommand().setIndexCount(index_count).setInstanceCount(0);
+						cmd.updateBuffer(buffer.indirect, 0, sizeof(args), &args);
+						cmd.pipelineBarrier(
+							vk::PipelineStageFlagBits::eTransfer,
+							vk::PipelineStageFlagBits::eComputeShader,
+							vk::DependencyFlags(),
+							{ vk::MemoryBarrier().setSrcAccessMask(vk::AccessFlagBits::eTransferWrite).setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite) },
+							nullptr, nullptr
+						);
+						cmd.bindPipeline(vk::PipelineBindPoint::eCompute, cull.pipeline);
+						cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, cull.pipeline_layout, 0, { frames[slot].cull_set }, nullptr);
+						auto constant = cull_constant_t{ mvp(rect.extent), count, (std::uint32_t)cell_e::e_empty, lod_level(rect.extent) };
+						cmd.pushConstants(cull.pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(constant), &constant);
+						cmd.dispatchIndirect(frames[slot].chunk_list, 0);
+						cmd.pipelineBarrier(
+							vk::PipelineStageFlagBits::eComputeShader,
+							vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+							vk::DependencyFlags(),
+							{ vk::MemoryBarrier().setSrcAccessMask(vk::AccessFlagBits::eShaderWrite).setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead) },
+							nullptr, nullptr
+						);
+					}
+				});
+			}
+			window->add_render_func(
+				[this](vk::CommandBuffer cmd, vk::Rect2D rect, std::uint32_t slot) {
 					auto viewport = vk::Viewport()
 						.setWidth((float)rect.extent.width)
 						.setHeight((float)rect.extent.height)
@@ -823,28 +1295,43 @@ private:
 					cmd.setScissor(0, { rect });
 					// pipeline layout and descriptor can used for different pipeline
 					cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline.pipeline_layout, 0, pipeline.descriptor_sets, nullptr);
+					auto constant = constant_t{ mvp(rect.extent), lod_level(rect.extent) };
+					cmd.pushConstants(pipeline.pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(constant), &constant);
 
 					cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline);
 					cmd.bindVertexBuffers(0, { buffer.vertex }, { 0 });
-					cmd.bindVertexBuffers(1, { buffer.instance }, { 0 });
 					cmd.bindIndexBuffer(buffer.index, 0, vk::IndexType::eUint32);
-					auto count = buffer.instance.byte() / sizeof(instance_t);
-					cmd.drawIndexed(buffer.index.byte() / sizeof(std::uint32_t), count, 0, 0, 0);
+					if (cull.pipeline) {
+						cmd.bindVertexBuffers(1, { buffer.visible }, { 0 });
+						cmd.drawIndexedIndirect(buffer.indirect, 0, 1, sizeof(vk::DrawIndexedIndirectCommand));
+					}
+					else {
+						// one draw per chunk, the chunks out of view have no instances
+						for (std::uint32_t i = 0; i < chunk_count(lod_level(rect.extent)); ++i) {
+							cmd.bindVertexBuffers(1, { frames[slot].instance }, { static_cast<vk::DeviceSize>(i) * chunk_cells() * sizeof(instance_t) });
+							cmd.drawIndexedIndirect(frames[slot].chunk_draw, i * sizeof(vk::DrawIndexedIndirectCommand), 1, sizeof(vk::DrawIndexedIndirectCommand));
+						}
+					}
 				}
-			});
+			);
 		}
-		decltype(auto) build(std::unique_ptr<dev::window_group_t>& window_group, std::vector<std::vector<cell_e>>* map) {
+		decltype(auto) build(std::unique_ptr<dev::window_group_t>& window_group, std::vector<std::vector<cell_e>>* map, std::vector<core::offset2_t<core::ull_t>>* changed, core::frame_arena_t* arena) {
 			this->map = map;
+			this->changed = changed;
+			this->arena = arena;
+			build_lod();
 			build_vulkan(window_group);
 			build_buffer();
 			build_texture();
 			build_layout();
 			build_pipeline();
+			build_cull();
 			
 			render();
 		}
 		decltype(auto) clean() {
 			
+			clean_cull();
 			clean_pipeline();
 			clean_layout();
 			clean_texture();
@@ -852,40 +1339,87 @@ private:
 			clean_vulkan();
 		}
 		
-		decltype(auto) update(std::queue<dev::event_t> queue) {
-			while (!queue.empty()) {
-				auto event = queue.front();
-				if (event.etype == dev::event_e::e_resize) update_mvp();
-				queue.pop();
+		decltype(auto) update(core::frame_vector_t<dev::event_t> const& events) {
+			CW_TRACE_ZONE("vulkan::update");
+			CW_ALLOC_TAG(e_render);
+			bool moved = false;
+			for (const auto& event : events) {
+				if (event.etype == dev::event_e::e_keydown) {
+					window->mark_input();
+					moved = move_camera(std::get<dev::key_e>(event.detail)) || moved;
+				}
+				if (event.etype == dev::event_e::e_resize || event.etype == dev::event_e::e_rect) {
+					auto extent = event.etype == dev::event_e::e_resize ? std::get<dev::extent_t>(event.detail) : std::get<dev::rect_t>(event.detail).m_extent;
+					window->resize({ extent.width(), extent.height() });
+				}
 			}
+			if (moved) window->record();
+			update_lod();
 			update_instance();
 			window->run();
 		}
 	}m_vulkan;
 public:
+	// false when a frame after the warmup of the allocation check allocated
 	decltype(auto) run() {
+		auto& tracker = core::alloc_tracker_t::instance();
+		tracker.end_frame();
+		core::ull_t failed_frame = 0, frame = 0;
+		auto start = std::chrono::steady_clock::now();
+		m_logic.last_time = m_window_group->now();
 		while (m_window_group->is_active()) {
-			auto& queue = m_window_group->update();
-			m_logic.update(queue);
-			m_vulkan.update(queue);
-			if (m_console) m_logic.console_display();
+			{
+				CW_TRACE_ZONE("snake_game_t::run");
+				m_frame_arena.begin_frame();
+				auto& queue = [this]() -> decltype(auto) { CW_ALLOC_TAG(e_window); return m_window_group->update(); }();
+				// one copy of the events in the frame arena, read by the logic and the renderer
+				CW_ALLOC_TAG(e_core);
+				auto events = core::frame_vector_t<dev::event_t>(core::frame_allocator_t<dev::event_t>(&m_frame_arena));
+				events.reserve(queue.size());
+				for (; !queue.empty(); queue.pop()) events.push_back(queue.front());
+				m_logic.update(events, m_window_group->now());
+				m_vulkan.update(events);
+				if (m_console) m_logic.console_display();
+				++frame;
+			}
+			auto& report = tracker.end_frame();
+			if (m_alloc_check_warmup != 0 && report.frame >= m_alloc_check_warmup && report.alloc_count() != 0) {
+				if (failed_frame == 0) report.log(std::cerr);
+				++failed_frame;
+			}
+			if (m_alloc_report_interval != 0 && report.frame % m_alloc_report_interval == 0) report.log(std::cout);
 		}
+		if (m_alloc_report_interval != 0) tracker.log(std::cout);
+		if (m_script) {
+			std::cout << "replayed " << frame << " frames in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << "ms" << std::endl;
+			m_logic.log_latency(std::cout);
+		}
+		if (m_alloc_check_warmup != 0) std::cout << failed_frame << " frames allocated after the first " << m_alloc_check_warmup << std::endl;
+		return failed_frame == 0;
 	}
 public:
-	snake_game_t(snake_game_ci_t const& ci) : m_console(ci.console_game) {
+	snake_game_t(snake_game_ci_t const& ci) : m_console(ci.console_game), m_alloc_report_interval(ci.alloc_report_interval), m_alloc_check_warmup(ci.alloc_check_warmup), m_script(ci.script.has_value()) {
 		// build window
-		dev::extent_t window_extent = { static_cast<core::u32_t>((ci.extent.width() + 1) * ci.window_rate), static_cast<core::u32_t>((ci.extent.height() + 1) * ci.window_rate) };
-		m_window_group = dev::build_window_group(
-			dev::window_group_ci_t()
-			.set_title(L"Vulkan Snake")
-			.set_rect({ {200, 100}, window_extent })
-		);
+		// boards larger than the screen are explored with the camera
+		dev::extent_t window_extent = { static_cast<core::u32_t>(std::min<core::ull_t>((ci.extent.width() + 1) * ci.window_rate, 1280)), static_cast<core::u32_t>(std::min<core::ull_t>((ci.extent.height() + 1) * ci.window_rate, 960)) };
+		if (ci.script.has_value()) m_window_group = dev::build_script_window_group(dev::window_group_script_ci_t(ci.script.value()).set_extent(window_extent));
+		else {
+			m_window_group = dev::build_window_group(
+				dev::window_group_ci_t()
+				.set_title(L"Vulkan Snake")
+				.set_rect({ {200, 100}, window_extent })
+			);
+		}
 
 		// build logic
 		m_logic.build(ci.win_score, ci.difficulty, ci.extent);
 
 		// build vulkan
-		m_vulkan.build(m_window_group, &m_logic.map);
+		m_vulkan.profile_interval = ci.profile_interval;
+		m_vulkan.present_policy = ci.present_policy;
+		m_vulkan.record_threads = ci.record_threads;
+		m_vulkan.capture_path = ci.capture_path;
+		m_vulkan.build(m_window_group, &m_logic.map, &m_logic.changed, &m_frame_arena);
 	}
 	~snake_game_t() {
 		m_vulkan.clean();
@@ -893,13 +1427,149 @@ public:
 	}
 };
 
+// step the same boards on the cpu and with batch.comp, every copy read back from the gpu must match the cpu words
+static decltype(auto) batch_check(std::uint32_t board_count, std::uint32_t tick_count) {
+	auto ci = snake_batch_ci_t().set_board_count(board_count).set_seed(20);
+	auto device = std::make_unique<vku::device_t>(vku::device_ci_t().set_surface(false).set_usage(vku::device_usage_t()));
+	snake_batch_t cpu(ci);
+	snake_batch_gpu_t gpu(device.get(), ci);
+	if (!gpu.is_valid()) { std::cerr << "can't build the batch pipeline, compile batch.comp first" << std::endl; return false; }
+	gpu.upload(cpu.words());
+	core::thread_pool_t pool;
+	std::deque<std::pair<std::uint64_t, std::vector<std::uint32_t>>> expects;
+	core::ull_t compared = 0, mismatched = 0;
+	auto compare = [&](snake_batch_gpu_t::readback_t const& readback) {
+		while (!expects.empty() && expects.front().first < readback.tick) expects.pop_front();
+		assert(!expects.empty() && expects.front().first == readback.tick);
+		auto& expect = expects.front().second;
+		for (std::uint32_t i = 0; i < board_count; ++i) {
+			auto first = expect.begin() + static_cast<std::ptrdiff_t>(cpu.stride()) * i;
+			if (!std::equal(first, first + cpu.stride(), readback.words.begin() + static_cast<std::ptrdiff_t>(cpu.stride()) * i)) {
+				if (mismatched == 0) std::cerr << "board " << i << " differs at tick " << readback.tick << std::endl;
+				++mismatched;
+			}
+		}
+		++compared;
+	};
+	// mostly straight runs, a board turns about every eighth tick
+	std::vector<std::uint32_t> directions(board_count);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (std::uint32_t tick = 1; tick <= tick_count; ++tick) {
+		for (std::uint32_t i = 0; i < board_count; ++i) {
+			auto random = snake_batch_t::hash(tick * 0x9e3779b9u ^ snake_batch_t::hash(i));
+			directions[i] = random % 8 < 4 ? random % 8 : snake_batch_t::e_direction_null;
+		}
+		cpu.step(directions, &pool);
+		bool readback = tick % 16 == 0 || tick == tick_count;
+		gpu.step(directions, readback);
+		if (readback) expects.push_back({ gpu.tick(), cpu.words() });
+		while (auto result = gpu.poll()) compare(result.value());
+	}
+	while (auto result = gpu.wait()) compare(result.value());
+	auto time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	core::ull_t win = 0, failed = 0;
+	for (std::uint32_t i = 0; i < board_count; ++i) {
+		if (cpu.state(i) == snake_batch_t::e_win) ++win;
+		else if (cpu.state(i) == snake_batch_t::e_failed) ++failed;
+	}
+	std::cout << board_count << " boards, " << tick_count << " ticks in " << time << "ms : " << win << " win, " << failed << " failed, "
+		<< compared << " readbacks compared, " << mismatched << " boards differ" << std::endl;
+	device->log_memory(std::cout);
+	return compared != 0 && mismatched == 0;
+}
+
 int main(int argc, char** argv) {
+	// snake --pack [--bc3] : write ./res/texture/cell.bundle from the png files
+	if (argc > 1 && std::string(argv[1]) == "--pack") {
+		bool compress = argc > 2 && std::string(argv[2]) == "--bc3";
+		return snake_game_t::pack_textures("./res/texture/", "./res/texture/cell.bundle", compress) ? 0 : 1;
+	}
+	// the options below can be combined, an option value is optional
+	auto find_option = [argc, argv](std::string const& name) -> std::optional<std::string> {
+		for (int i = 1; i < argc; ++i) {
+			if (name != argv[i]) continue;
+			if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) return std::string(argv[i + 1]);
+			return std::string();
+		}
+		return std::nullopt;
+	};
+	// --batch-check [boards] : compare the cpu and the compute batch engines without a window, works on software drivers
+	if (auto option = find_option("--batch-check")) return batch_check(option.value().empty() ? 4096 : static_cast<std::uint32_t>(std::stoul(option.value())), 512) ? 0 : 1;
+	// --profile [frames] : log gpu timings of every render pass and the present latency, every 300 frames by default
+	std::uint32_t profile_interval = 0;
+	if (auto option = find_option("--profile")) profile_interval = option.value().empty() ? 300 : static_cast<std::uint32_t>(std::stoul(option.value()));
+	// --present latency|power|tear_free : present mode policy, follows vsync by default
+	auto present_policy = vku::present_policy_e::e_null;
+	if (auto option = find_option("--present")) {
+		if (option.value() == "latency") present_policy = vku::present_policy_e::e_lowest_latency;
+		else if (option.value() == "power") present_policy = vku::present_policy_e::e_lowest_power;
+		else if (option.value() == "tear_free") present_policy = vku::present_policy_e::e_tear_free;
+		else std::cerr << "unknown present policy \"" << option.value() << "\"" << std::endl;
+	}
+	// --record-threads [count] : record the render funcs into secondary command buffers on count workers, one per hardware thread by default
+	std::uint32_t record_threads = 0;
+	if (auto option = find_option("--record-threads")) record_threads = option.value().empty() ? (std::max)(1u, std::thread::hardware_concurrency()) : static_cast<std::uint32_t>(std::stoul(option.value()));
+	// --trace [path] : write the cpu trace zones as chrome trace json on exit, needs CW_CONFIG_ENABLE_TRACE
+	std::string trace_path;
+	if (auto option = find_option("--trace")) trace_path = option.value().empty() ? "./snake.trace.json" : option.value();
+#ifndef CW_CONFIG_ENABLE_TRACE
+	if (!trace_path.empty()) std::cerr << "built without CW_CONFIG_ENABLE_TRACE, the trace will be empty" << std::endl;
+#endif
+	core::tracer_t::instance().set_enabled(!trace_path.empty());
+	// --alloc-report [frames] : log the heap allocations per subsystem, every 300 frames by default, needs CW_CONFIG_ENABLE_ALLOC_TRACKING
+	std::uint32_t alloc_report_interval = 0;
+	if (auto option = find_option("--alloc-report")) alloc_report_interval = option.value().empty() ? 300 : static_cast<std::uint32_t>(std::stoul(option.value()));
+	// --alloc-check [frames] : fail when a frame allocates after the first 120 frames by default, needs CW_CONFIG_ENABLE_ALLOC_TRACKING
+	std::uint32_t alloc_check_warmup = 0;
+	if (auto option = find_option("--alloc-check")) alloc_check_warmup = option.value().empty() ? 120 : (std::max)(1u, static_cast<std::uint32_t>(std::stoul(option.value())));
+#ifndef CW_CONFIG_ENABLE_ALLOC_TRACKING
+	if (alloc_report_interval != 0 || alloc_check_warmup != 0) std::cerr << "built without CW_CONFIG_ENABLE_ALLOC_TRACKING, no allocation is counted" << std::endl;
+#endif
+	// --capture [path] : write the first drawn frame as a binary ppm, ./snake.ppm by default
+	std::string capture_path;
+	if (auto option = find_option("--capture")) capture_path = option.value().empty() ? "./snake.ppm" : option.value();
+	// --board WxH : board size in cells, at least 3x3, the console only shows boards up to 80 cells wide
+	auto extent = snake_game_ci_t().extent;
+	if (auto option = find_option("--board")) {
+		// digits only and short enough not to overflow, std::stoull alone would accept "-1", " 7" or "5abc" and throw on "abc"
+		auto parse = [](std::string const& text) -> std::optional<core::ull_t> {
+			if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos) return std::nullopt;
+			return std::stoull(text);
+		};
+		auto separator = option.value().find('x');
+		auto width = separator != std::string::npos ? parse(option.value().substr(0, separator)) : std::nullopt;
+		auto height = separator != std::string::npos ? parse(option.value().substr(separator + 1)) : std::nullopt;
+		if (width.has_value() && height.has_value() && width.value() >= 3 && height.value() >= 3) extent = { width.value(), height.value() };
+		else std::cerr << "can't parse board size \"" << option.value() << "\", expected WxH of at least 3x3" << std::endl;
+	}
+	// --script path : replay the events of the file without a window, see window_group_script.hpp for the format
+	// --replay real|max : send the events in real time or step the clock a frame per update as fast as possible, real by default
+	std::optional<dev::window_group_script_ci_t> script;
+	if (auto option = find_option("--script")) {
+		auto events = dev::func::load_script(option.value());
+		if (!events.has_value()) return 1;
+		script = dev::window_group_script_ci_t().set_events(events.value());
+		if (auto replay = find_option("--replay")) {
+			if (replay.value() == "max") script.value().set_replay(dev::replay_e::e_max_speed);
+			else if (replay.value() != "real") std::cerr << "unknown replay \"" << replay.value() << "\"" << std::endl;
+		}
+	}
+	auto game_ci = snake_game_ci_t()
+		.set_extent(extent)
+		.set_console_game(extent.width() <= 80 && !script.has_value())
+		.set_profile_interval(profile_interval)
+		.set_present_policy(present_policy)
+		.set_record_threads(record_threads)
+		.set_alloc_report_interval(alloc_report_interval)
+		.set_alloc_check_warmup(alloc_check_warmup)
+		.set_capture_path(capture_path);
+		//.set_something() or by default
+	if (script.has_value()) game_ci.set_script(script.value());
+	bool passed = true;
 	{ 
-		snake_game_t(
-			snake_game_ci_t()
-			.set_console_game(true)
-			//.set_something() or by default
-		).run(); 
+		passed = snake_game_t(game_ci).run(); 
 	}
+	if (!trace_path.empty()) core::tracer_t::instance().write_chrome_trace(trace_path);
+	if (!passed) return 1;
 	//std::cin.get();
 }
\ No newline at end of file
@@ -0,0 +1,438 @@
+#pragma once
+
+#include "./../inc/graphic/vulkan/vulkan.hpp"
+#include "./../inc/core/thread_pool.hpp"
+#include "./../inc/core/trace.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+/*
+	many snake games advanced together, for training and benchmarking rather than playing
+	every board follows snake_game_t::game_logic, directions are given per board and per tick
+	the random numbers come from a counter based hash, so snake_batch_t and snake_batch_gpu_t produce the same words
+
+	board layout (std::uint32_t words, mirrored by batch.comp) :
+		0 state, 1 direction, 2 food, 3 length, 4 head, 5 random counter, 6 seed, 7 tick
+		8 .. 8 + w * h						cells
+		8 + w * h .. 8 + 2 * w * h			snake body ring, positions packed as x | y << 16
+*/
+struct snake_batch_ci_t {
+	std::uint32_t width = 30;
+	std::uint32_t height = 20;
+	std::uint32_t board_count = 4096;
+	std::uint32_t win_score = 30; // must leave room for food, win_score + 2 < (width - 2) * (height - 2)
+	std::uint32_t seed = 0;
+	decltype(auto) set_width(std::uint32_t width) { this->width = width; return *this; }
+	decltype(auto) set_height(std::uint32_t height) { this->height = height; return *this; }
+	decltype(auto) set_board_count(std::uint32_t board_count) { this->board_count = board_count; return *this; }
+	decltype(auto) set_win_score(std::uint32_t win_score) { this->win_score = win_score; return *this; }
+	decltype(auto) set_seed(std::uint32_t seed) { this->seed = seed; return *this; }
+};
+
+// cpu reference, the words of every board live in one vector
+class snake_batch_t {
+public:
+	enum word_e : std::uint32_t {
+		e_state, e_direction, e_food, e_length, e_head, e_counter, e_seed, e_tick, e_header
+	};
+	enum state_e : std::uint32_t { e_win, e_failed, e_continue };
+	enum direction_e : std::uint32_t { e_left, e_right, e_up, e_down, e_direction_null };
+	enum cell_e : std::uint32_t { e_empty, e_wall, e_food_cell, e_head_cell, e_body, e_tail };
+	static constexpr std::uint32_t no_food = 0xffffffffu;
+
+	static decltype(auto) hash(std::uint32_t value) {
+		std::uint32_t state = value * 747796405u + 2891336453u;
+		std::uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+		return (word >> 22u) ^ word;
+	}
+
+	decltype(auto) ci() const { return (m_ci); }
+	decltype(auto) stride() const { return e_header + 2 * m_ci.width * m_ci.height; }
+	decltype(auto) words() const { return (m_words); }
+	decltype(auto) board(std::uint32_t index) { return m_words.data() + static_cast<std::size_t>(stride()) * index; }
+	decltype(auto) board(std::uint32_t index) const { return m_words.data() + static_cast<std::size_t>(stride()) * index; }
+	decltype(auto) state(std::uint32_t index) const { return static_cast<state_e>(board(index)[e_state]); }
+	decltype(auto) score(std::uint32_t index) const { return board(index)[e_length] == 0 ? 0 : board(index)[e_length] - 1; }
+
+	snake_batch_t(snake_batch_ci_t const& ci) : m_ci(ci) {
+		assert(m_ci.width > 2 && m_ci.height > 2 && m_ci.width < 0x10000 && m_ci.height < 0x10000);
+		assert(m_ci.win_score + 2 < (m_ci.width - 2) * (m_ci.height - 2));
+		m_words.resize(static_cast<std::size_t>(stride()) * m_ci.board_count);
+		for (std::uint32_t i = 0; i < m_ci.board_count; ++i) reset(i);
+	}
+
+	// an empty walled board, the seed of board i is hash(seed ^ i)
+	void reset(std::uint32_t index) {
+		auto words = board(index);
+		std::fill(words, words + stride(), 0u);
+		words[e_state] = e_continue;
+		words[e_direction] = e_direction_null;
+		words[e_food] = no_food;
+		words[e_seed] = hash(m_ci.seed ^ index);
+		auto cells = words + e_header;
+		for (std::uint32_t y = 0; y < m_ci.height; ++y) {
+			for (std::uint32_t x = 0; x < m_ci.width; ++x) {
+				if (x == 0 || y == 0 || x == m_ci.width - 1 || y == m_ci.height - 1) cells[x + y * m_ci.width] = e_wall;
+			}
+		}
+	}
+	// one tick of every board, directions holds one direction_e per board
+	void step(std::vector<std::uint32_t> const& directions, cw::core::thread_pool_t* thread_pool = nullptr) {
+		CW_TRACE_ZONE("batch::step");
+		assert(directions.size() == m_ci.board_count);
+		if (!thread_pool) {
+			for (std::uint32_t i = 0; i < m_ci.board_count; ++i) step_board(board(i), directions[i]);
+			return;
+		}
+		auto chunk = (m_ci.board_count + thread_pool->size() - 1) / thread_pool->size();
+		thread_pool->parallel_for(thread_pool->size(), [&](cw::core::ull_t i) {
+			auto end = std::min<cw::core::ull_t>((i + 1) * chunk, m_ci.board_count);
+			for (auto j = i * chunk; j < end; ++j) step_board(board(static_cast<std::uint32_t>(j)), directions[j]);
+		});
+	}
+private:
+	// keep in sync with main() of batch.comp
+	void step_board(std::uint32_t* words, std::uint32_t requested) const {
+		if (words[e_state] != e_continue) return;
+		words[e_tick] += 1;
+
+		auto capacity = m_ci.width * m_ci.height;
+		auto cells = words + e_header;
+		auto ring = cells + capacity;
+		auto cell = [&](std::uint32_t pos) -> std::uint32_t& { return cells[(pos & 0xffffu) + (pos >> 16) * m_ci.width]; };
+		auto random = [&]() { return hash(words[e_seed] ^ hash(words[e_counter]++)); };
+		auto random_unique = [&]() {
+			std::uint32_t result;
+			do {
+				auto x = 1 + random() % (m_ci.width - 2);
+				auto y = 1 + random() % (m_ci.height - 2);
+				result = x | (y << 16);
+			} while (cell(result) != e_empty);
+			return result;
+		};
+		auto push_front = [&](std::uint32_t pos) {
+			words[e_head] = (words[e_head] + capacity - 1) % capacity;
+			ring[words[e_head]] = pos;
+			words[e_length] += 1;
+		};
+		auto front = [&]() { return ring[words[e_head]]; };
+		auto back = [&]() { return ring[(words[e_head] + words[e_length] - 1) % capacity]; };
+
+		// a turn back onto the body is ignored, as in caculate_direction
+		auto current = words[e_direction];
+		if (requested != e_direction_null && !(current != e_direction_null && (current ^ 1u) == requested)) current = requested;
+		words[e_direction] = current;
+
+		// the food is marked right away, so the spawn below never lands on it
+		if (words[e_food] == no_food) { words[e_food] = random_unique(); cell(words[e_food]) = e_food_cell; }
+		if (words[e_length] == 0) push_front(random_unique());
+
+		auto head = front();
+		auto x = head & 0xffffu, y = head >> 16;
+		switch (current) {
+		case e_up: { y -= 1; }break;
+		case e_down: { y += 1; }break;
+		case e_left: { x -= 1; }break;
+		case e_right: { x += 1; }break;
+		}
+		auto next = x | (y << 16);
+		auto food = words[e_food];
+		if (next != food && next != head && cell(next) != e_empty) { words[e_state] = e_failed; return; }
+
+		cell(food) = e_food_cell;
+		cell(head) = e_body;
+		cell(back()) = e_empty;
+		push_front(next);
+
+		if (next != food) words[e_length] -= 1;
+		else words[e_food] = no_food;
+
+		cell(back()) = e_tail;
+		cell(front()) = e_head_cell;
+
+		if (words[e_length] > m_ci.win_score) words[e_state] = e_win;
+	}
+private:
+	snake_batch_ci_t m_ci;
+	std::vector<std::uint32_t> m_words;
+};
+
+/*
+	the same boards resident in a device local storage buffer, stepped by batch.comp on the compute queue
+	every step is one dispatch, submissions are double buffered and a step may copy the boards back to the host,
+	the copies are collected later by poll() without stalling the next steps
+*/
+class snake_batch_gpu_t {
+public:
+	struct readback_t {
+		std::uint64_t tick = 0; // steps submitted before the copy
+		std::vector<std::uint32_t> words;
+	};
+
+	snake_batch_gpu_t(const cw::vku::device_t* device, snake_batch_ci_t const& ci, std::filesystem::path const& shader_path = "./res/shader/batch.comp.spv") : m_device(device), m_ci(ci) {
+		assert(m_device);
+		auto module = m_device->build_shader(shader_path);
+		if (!module) return;
+		m_byte = static_cast<vk::DeviceSize>(e_header + 2 * m_ci.width * m_ci.height) * m_ci.board_count * sizeof(std::uint32_t);
+		auto& family = m_device->get_queue_family(vk::QueueFlagBits::eCompute);
+		m_queue = family.queues[0];
+
+		m_state = cw::vku::buffer_t(
+			cw::vku::buffer_ci_t()
+			.set_device(m_device)
+			.set_usage_flags(vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst)
+			.set_intent(cw::vku::memory_intent_e::e_static)
+			.set_byte(m_byte)
+		);
+		std::vector<vk::DescriptorSetLayoutBinding> bindings;
+		for (std::uint32_t i = 0; i < 2; ++i) bindings.push_back(vk::DescriptorSetLayoutBinding().setStageFlags(vk::ShaderStageFlagBits::eCompute).setDescriptorType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(1).setBinding(i));
+		m_descriptor_set_layout = vk::Device(*m_device).createDescriptorSetLayout(
+			vk::DescriptorSetLayoutCreateInfo()
+			.setBindingCount(bindings.size())
+			.setPBindings(bindings.data())
+		);
+		auto push_constant_range = vk::PushConstantRange()
+			.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+			.setOffset(0)
+			.setSize(sizeof(constant_t));
+		m_pipeline_layout = vk::Device(*m_device).createPipelineLayout(
+			vk::PipelineLayoutCreateInfo()
+			.setSetLayoutCount(1)
+			.setPSetLayouts(&m_descriptor_set_layout)
+			.setPushConstantRangeCount(1)
+			.setPPushConstantRanges(&push_constant_range)
+		);
+		auto pool_size = vk::DescriptorPoolSize().setType(vk::DescriptorType::eStorageBuffer).setDescriptorCount(2 * slot_count);
+		m_descriptor_pool = vk::Device(*m_device).createDescriptorPool(
+			vk::DescriptorPoolCreateInfo()
+			.setPoolSizeCount(1)
+			.setPPoolSizes(&pool_size)
+			.setMaxSets(slot_count)
+		);
+		m_command_pool = vk::Device(*m_device).createCommandPool(
+			vk::CommandPoolCreateInfo()
+			.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer)
+			.setQueueFamilyIndex(family.index)
+		);
+		auto cmds = vk::Device(*m_device).allocateCommandBuffers(
+			vk::CommandBufferAllocateInfo()
+			.setCommandPool(m_command_pool)
+			.setCommandBufferCount(slot_count)
+			.setLevel(vk::CommandBufferLevel::ePrimary)
+		);
+		for (std::uint32_t i = 0; i < slot_count; ++i) {
+			auto& slot = m_slots[i];
+			slot.cmd = cmds[i];
+			slot.fence = vk::Device(*m_device).createFence(vk::FenceCreateInfo().setFlags(vk::FenceCreateFlagBits::eSignaled));
+			slot.directions = cw::vku::buffer_t(
+				cw::vku::buffer_ci_t()
+				.set_device(m_device)
+				.set_usage_flags(vk::BufferUsageFlagBits::eStorageBuffer)
+				.set_intent(cw::vku::memory_intent_e::e_upload)
+				.set_byte(static_cast<vk::DeviceSize>(m_ci.board_count) * sizeof(std::uint32_t))
+			);
+			slot.readback = cw::vku::buffer_t(
+				cw::vku::buffer_ci_t()
+				.set_device(m_device)
+				.set_usage_flags(vk::BufferUsageFlagBits::eTransferDst)
+				.set_intent(cw::vku::memory_intent_e::e_readback)
+				.set_byte(m_byte)
+			);
+			slot.descriptor_set = vk::Device(*m_device).allocateDescriptorSets(
+				vk::DescriptorSetAllocateInfo()
+				.setDescriptorPool(m_descriptor_pool)
+				.setDescriptorSetCount(1)
+				.setPSetLayouts(&m_descriptor_set_layout)
+			)[0];
+			vk::DescriptorBufferInfo buffer_infos[2] = {
+				vk::DescriptorBufferInfo().setBuffer(m_state).setOffset(0).setRange(m_state.byte()),
+				vk::DescriptorBufferInfo().setBuffer(slot.directions).setOffset(0).setRange(slot.directions.byte())
+			};
+			std::vector<vk::WriteDescriptorSet> writes;
+			for (std::uint32_t j = 0; j < 2; ++j) {
+				writes.push_back(
+					vk::WriteDescriptorSet()
+					.setDescriptorType(vk::DescriptorType::eStorageBuffer)
+					.setDescriptorCount(1)
+					.setDstSet(slot.descriptor_set)
+					.setDstBinding(j)
+					.setPBufferInfo(&buffer_infos[j])
+				);
+			}
+			vk::Device(*m_device).updateDescriptorSets(writes, nullptr);
+		}
+		m_pipeline = vk::Device(*m_device).createComputePipeline(nullptr,
+			vk::ComputePipelineCreateInfo()
+			.setLayout(m_pipeline_layout)
+			.setStage(
+				vk::PipelineShaderStageCreateInfo()
+				.setStage(vk::ShaderStageFlagBits::eCompute)
+				.setModule(module)
+				.setPName("main"))
+		);
+		m_device->clean_shader(module);
+	}
+	snake_batch_gpu_t(snake_batch_gpu_t const&) = delete;
+	snake_batch_gpu_t& operator=(snake_batch_gpu_t const&) = delete;
+	~snake_batch_gpu_t() { clean(); }
+
+	// false without the compiled batch.comp.spv
+	decltype(auto) is_valid() const { return static_cast<bool>(m_pipeline); }
+	decltype(auto) tick() const { return m_tick; }
+	// replace the boards, waits for the steps in flight
+	void upload(std::vector<std::uint32_t> const& words) {
+		assert(is_valid() && words.size() * sizeof(std::uint32_t) == m_byte);
+		wait_idle();
+		auto staging = cw::vku::buffer_t(
+			cw::vku::buffer_ci_t()
+			.set_device(m_device)
+			.set_usage_flags(vk::BufferUsageFlagBits::eTransferSrc)
+			.set_intent(cw::vku::memory_intent_e::e_staging)
+			.set_memory_view(cw::core::memory_view_t(m_byte, (void*)words.data()))
+		);
+		auto copy_cmd = m_device->begin_single_command(vk::QueueFlagBits::eCompute);
+		copy_cmd.first.copyBuffer(staging, m_state, { vk::BufferCopy().setSize(m_byte) });
+		m_device->end_single_command(copy_cmd);
+		m_tick = 0;
+	}
+	// one tick of every board, with readback the boards after this tick are copied back for poll() / wait()
+	void step(std::vector<std::uint32_t> const& directions, bool readback = false) {
+		CW_TRACE_ZONE("batch::gpu_step");
+		assert(is_valid() && directions.size() == m_ci.board_count);
+		auto& slot = m_slots[m_cursor];
+		m_cursor = (m_cursor + 1) % slot_count;
+		// the slot is reused two steps later, its copy has to be collected before it is overwritten
+		vk::Device(*m_device).waitForFences({ slot.fence }, VK_TRUE, UINT64_MAX);
+		if (slot.pending) collect(slot);
+		vk::Device(*m_device).resetFences({ slot.fence });
+		slot.directions.copy_from(cw::core::memory_view_t(slot.directions.byte(), (void*)directions.data()));
+
+		auto& cmd = slot.cmd;
+		cmd.reset(vk::CommandBufferResetFlags());
+		cmd.begin(vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+		// the previous step wrote the boards, a previous copy may still read them
+		cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eComputeShader,
+			vk::DependencyFlags(),
+			{ vk::MemoryBarrier().setSrcAccessMask(vk::AccessFlagBits::eShaderWrite).setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite) },
+			nullptr, nullptr
+		);
+		constant_t constant{ m_ci.width, m_ci.height, m_ci.board_count, m_ci.win_score };
+		cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+		cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_pipeline_layout, 0, { slot.descriptor_set }, nullptr);
+		cmd.pushConstants(m_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(constant), &constant);
+		cmd.dispatch((m_ci.board_count + group_size - 1) / group_size, 1, 1);
+		if (readback) {
+			cmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eComputeShader,
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::DependencyFlags(),
+				{ vk::MemoryBarrier().setSrcAccessMask(vk::AccessFlagBits::eShaderWrite).setDstAccessMask(vk::AccessFlagBits::eTransferRead) },
+				nullptr, nullptr
+			);
+			cmd.copyBuffer(m_state, slot.readback, { vk::BufferCopy().setSize(m_byte) });
+			cmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eHost,
+				vk::DependencyFlags(),
+				{ vk::MemoryBarrier().setSrcAccessMask(vk::AccessFlagBits::eTransferWrite).setDstAccessMask(vk::AccessFlagBits::eHostRead) },
+				nullptr, nullptr
+			);
+		}
+		cmd.end();
+		m_queue.submit({ vk::SubmitInfo().setCommandBufferCount(1).setPCommandBuffers(&cmd) }, slot.fence);
+		++m_tick;
+		if (readback) { slot.pending = true; slot.tick = m_tick; m_order.push_back(static_cast<std::uint32_t>(&slot - m_slots)); }
+	}
+	// the oldest finished copy, never waits
+	decltype(auto) poll() {
+		std::optional<readback_t> result;
+		while (!m_order.empty()) {
+			auto& slot = m_slots[m_order.front()];
+			if (vk::Device(*m_device).getFenceStatus(slot.fence) != vk::Result::eSuccess) break;
+			collect(slot);
+		}
+		if (!m_ready.empty()) { result = std::move(m_ready.front()); m_ready.pop_front(); }
+		return result;
+	}
+	// the oldest copy, waits for it when it is still in flight
+	decltype(auto) wait() {
+		std::optional<readback_t> result;
+		if (m_ready.empty() && !m_order.empty()) {
+			auto& slot = m_slots[m_order.front()];
+			vk::Device(*m_device).waitForFences({ slot.fence }, VK_TRUE, UINT64_MAX);
+			collect(slot);
+		}
+		if (!m_ready.empty()) { result = std::move(m_ready.front()); m_ready.pop_front(); }
+		return result;
+	}
+private:
+	static constexpr std::uint32_t e_header = snake_batch_t::e_header;
+	static constexpr std::uint32_t slot_count = 2;
+	static constexpr std::uint32_t group_size = 64; // local_size_x of batch.comp
+	struct constant_t {
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t board_count;
+		std::uint32_t win_score;
+	};
+	struct slot_t {
+		vk::CommandBuffer cmd;
+		vk::Fence fence;
+		vk::DescriptorSet descriptor_set;
+		cw::vku::buffer_t directions;
+		cw::vku::buffer_t readback;
+		bool pending = false;
+		std::uint64_t tick = 0;
+	};
+	// the fence of slot has signaled
+	void collect(slot_t& slot) {
+		readback_t result;
+		result.tick = slot.tick;
+		result.words.resize(static_cast<std::size_t>(m_byte / sizeof(std::uint32_t)));
+		memcpy(result.words.data(), slot.readback.map(), m_byte);
+		slot.readback.unmap();
+		slot.pending = false;
+		m_ready.push_back(std::move(result));
+		m_order.erase(std::find(m_order.begin(), m_order.end(), static_cast<std::uint32_t>(&slot - m_slots)));
+	}
+	void wait_idle() {
+		for (auto& iter : m_slots) vk::Device(*m_device).waitForFences({ iter.fence }, VK_TRUE, UINT64_MAX);
+		while (!m_order.empty()) collect(m_slots[m_order.front()]);
+	}
+	void clean() {
+		if (!m_pipeline) return;
+		wait_idle();
+		for (auto& iter : m_slots) {
+			vk::Device(*m_device).destroyFence(iter.fence);
+			iter.directions = nullptr;
+			iter.readback = nullptr;
+		}
+		vk::Device(*m_device).destroyCommandPool(m_command_pool);
+		vk::Device(*m_device).destroyPipeline(m_pipeline);
+		vk::Device(*m_device).destroyDescriptorPool(m_descriptor_pool);
+		vk::Device(*m_device).destroyPipelineLayout(m_pipeline_layout);
+		vk::Device(*m_device).destroyDescriptorSetLayout(m_descriptor_set_layout);
+		m_state = nullptr;
+		m_pipeline = nullptr;
+	}
+private:
+	const cw::vku::device_t* m_device = nullptr;
+	snake_batch_ci_t m_ci;
+	vk::DeviceSize m_byte = 0;
+	vk::Queue m_queue;
+	cw::vku::buffer_t m_state;
+	vk::DescriptorSetLayout m_descriptor_set_layout;
+	vk::PipelineLayout m_pipeline_layout;
+	vk::DescriptorPool m_descriptor_pool;
+	vk::CommandPool m_command_pool;
+	vk::Pipeline m_pipeline;
+	slot_t m_slots[slot_count];
+	std::uint32_t m_cursor = 0;
+	std::uint64_t m_tick = 0;
+	std::deque<std::uint32_t> m_order; // slots with a copy in flight, oldest first
+	std::deque<readback_t> m_ready;
+};